@@ -107,7 +107,7 @@ def createRenderMelProcedures():
     mel.eval('''
         global proc appleseedPauseIprRenderProcedure(string $editor, int $pause)
         {
-            appleseedProgressiveRender -action "pause";
+            appleseedProgressiveRender -action "pause" -pause $pause;
         }
         '''
              )
@@ -43,7 +43,8 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
         "exportAnim": False,
         "startFrame": 1,
         "endFrame": 100,
-        "stepFrame": 1
+        "stepFrame": 1,
+        "pipelinedExport": False
     }
 
     createGlobalNodes()
@@ -106,6 +107,11 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
                 edit=True,
                 enable=value)
 
+            mc.checkBoxGrp(
+                "as_exportOpts_pipelinedExport",
+                edit=True,
+                enable=value)
+
         exportAnim = defaults["exportAnim"]
         mc.checkBoxGrp(
             "as_exportOpts_exportAnim",
@@ -142,6 +148,14 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
             enable=exportAnim,
             value=defaults["stepFrame"])
 
+        mc.checkBoxGrp(
+            "as_exportOpts_pipelinedExport",
+            numberOfCheckBoxes=1,
+            label=" ",
+            label1="Write frames in background",
+            enable=exportAnim,
+            value1=defaults["pipelinedExport"])
+
     elif action == "query":
         options = ""
 
@@ -183,6 +197,11 @@ def translatorOptions(parent, action, initialSettings, resultCallback):
                 "as_exportOpts_stepFrame", query=True, value=True)
             options += "stepFrame=" + str(value) + ";"
 
+            pipelinedExport = mc.checkBoxGrp(
+                "as_exportOpts_pipelinedExport", query=True, value1=True)
+            if pipelinedExport:
+                options += "pipelinedExport=true;"
+
         logger.debug("calling translator callback, options = %s" % options)
         mel.eval('%s "%s"' % (resultCallback, options))
 
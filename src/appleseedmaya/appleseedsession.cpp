@@ -39,12 +39,17 @@
 #include "appleseedmaya/exporters/shadingengineexporter.h"
 #include "appleseedmaya/exporters/shadingnetworkexporter.h"
 #include "appleseedmaya/exporters/shapeexporter.h"
+#include "appleseedmaya/exportstatistics.h"
 #include "appleseedmaya/idlejobqueue.h"
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/parallel.h"
+#include "appleseedmaya/pixelbufferpool.h"
 #include "appleseedmaya/pythonbridge.h"
 #include "appleseedmaya/renderercontroller.h"
 #include "appleseedmaya/renderglobalsnode.h"
 #include "appleseedmaya/renderviewtilecallback.h"
+#include "appleseedmaya/sceneedittracker.h"
+#include "appleseedmaya/tracer.h"
 
 // Build options header.
 #include "foundation/core/buildoptions.h"
@@ -75,11 +80,14 @@
 #include <maya/MAnimControl.h>
 #include <maya/MCommonRenderSettingsData.h>
 #include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
 #include <maya/MFnDagNode.h>
 #include <maya/MFnDependencyNode.h>
+#include <maya/MFnExpression.h>
 #include <maya/MFnRenderLayer.h>
 #include <maya/MGlobal.h>
 #include <maya/MItDag.h>
+#include <maya/MItDependencyGraph.h>
 #include <maya/MSelectionList.h>
 #include <maya/MObject.h>
 #include <maya/MObjectArray.h>
@@ -92,10 +100,15 @@
 #include "boost/filesystem/operations.hpp"
 
 // Standard headers.
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -120,6 +133,8 @@ Options::Options()
   , m_lastFrame(1)
   , m_frameStep(1)
   , m_writeBoundingBox(false)
+  , m_pipelinedExport(false)
+  , m_maxPendingFrames(2)
 {
 }
 
@@ -198,6 +213,8 @@ namespace
 {
     struct SessionImpl;
 
+    void applySceneEdits();
+
     // Globals.
     bfs::path                       g_pluginPath;             // Plugin path.
     asf::SearchPaths                g_resourceSearchPaths;    // Paths to resources.
@@ -205,6 +222,46 @@ namespace
     asf::LogMessage::Category       g_savedLogLevel;          // Saved log level.
     std::unique_ptr<SessionImpl>    g_globalSession;          // Global session.
 
+    // Return true if a shading node or a node upstream of it changes over time:
+    // animation curves, time dependent expressions or image sequences.
+    bool isShadingNodeAnimated(const MObject& node)
+    {
+        MStatus status;
+        MObject root(node);
+        MItDependencyGraph iter(
+            root,
+            MFn::kInvalid,
+            MItDependencyGraph::kUpstream,
+            MItDependencyGraph::kDepthFirst,
+            MItDependencyGraph::kNodeLevel,
+            &status);
+
+        if (!status)
+            return true;
+
+        for (; !iter.isDone(); iter.next())
+        {
+            MObject upstreamNode = iter.currentItem();
+
+            if (upstreamNode.hasFn(MFn::kAnimCurve) || upstreamNode.hasFn(MFn::kTime))
+                return true;
+
+            if (upstreamNode.hasFn(MFn::kExpression))
+            {
+                MFnExpression fn(upstreamNode, &status);
+                if (status && fn.isAnimated())
+                    return true;
+            }
+
+            MFnDependencyNode depNodeFn(upstreamNode);
+            bool useFrameExtension = false;
+            if (AttributeUtils::get(depNodeFn, "useFrameExtension", useFrameExtension) && useFrameExtension)
+                return true;
+        }
+
+        return false;
+    }
+
     // RAII class to end active the session in an exception safe way.
     struct ScopedEndSession
     {
@@ -217,6 +274,12 @@ namespace
     struct SessionImpl
       : public asf::NonCopyable
     {
+        typedef std::map<MString, DagNodeExporterPtr, MStringCompareLess>           DagExporterMap;
+        typedef std::map<MString, ShadingEngineExporterPtr, MStringCompareLess>     ShadingEngineExporterMap;
+        typedef std::map<MString, ShadingNetworkExporterPtr, MStringCompareLess>    ShadingNetworkExporterMap;
+        typedef std::array<ShadingNetworkExporterMap, NumShadingNetworkContexts>    ShadingNetworkExporterMapArray;
+        typedef std::map<MString, AlphaMapExporterPtr, MStringCompareLess>          AlphaMapExporterMap;
+
         class ExporterFactory
           : public AppleseedSession::IExporterFactory
         {
@@ -242,6 +305,7 @@ namespace
                         *m_self.mainAssembly(),
                         m_self.m_sessionMode));
                 m_self.m_shadingEngineExporters[depNodeFn.name()] = exporter;
+                m_self.m_newShadingEngineExporters.push_back(exporter);
                 return exporter;
             }
 
@@ -265,6 +329,7 @@ namespace
                         *m_self.mainAssembly(),
                         m_self.m_sessionMode));
                 m_self.m_shadingNetworkExporters[context][depNodeFn.name()] = exporter;
+                m_self.m_newShadingNetworkExporters.push_back(exporter);
                 return exporter;
             }
 
@@ -285,7 +350,10 @@ namespace
                         m_self.m_sessionMode));
 
                 if (exporter)
+                {
                     m_self.m_alphaMapExporters[depNodeFn.name()] = exporter;
+                    m_self.m_newAlphaMapExporters.push_back(exporter);
+                }
 
                 return exporter;
             }
@@ -302,6 +370,13 @@ namespace
           , m_options(options)
           , m_computation(computation)
           , m_exporter_factory(*this)
+          , m_shutterOpenTime(0.0f)
+          , m_shutterCloseTime(0.0f)
+          , m_sceneScale(1.0f)
+          , m_persistent(false)
+          , m_sceneExported(false)
+          , m_paused(false)
+          , m_joiningRenderThread(false)
         {
             createProject();
         }
@@ -316,6 +391,13 @@ namespace
           , m_computation(computation)
           , m_exporter_factory(*this)
           , m_fileName(fileName)
+          , m_shutterOpenTime(0.0f)
+          , m_shutterCloseTime(0.0f)
+          , m_sceneScale(1.0f)
+          , m_persistent(false)
+          , m_sceneExported(false)
+          , m_paused(false)
+          , m_joiningRenderThread(false)
         {
             m_projectPath = bfs::path(fileName.asChar()).parent_path();
 
@@ -340,6 +422,7 @@ namespace
         ~SessionImpl()
         {
             PythonBridge::clearCurrentProject();
+            m_editTracker.reset();
             abortRender();
         }
 
@@ -411,8 +494,29 @@ namespace
             m_project->get_scene()->assembly_instances().insert(assemblyInstance);
         }
 
+        // Keep the session alive across the frames of a sequence export.
+        // Only the animated nodes are exported again for each new frame.
+        void setPersistent()
+        {
+            assert(m_sessionMode == AppleseedSession::ExportSession);
+            assert(!m_sceneExported);
+            m_persistent = true;
+        }
+
+        // Set the filename of the next frame of a persistent sequence export.
+        void setFileName(const MString& fileName)
+        {
+            assert(m_persistent);
+            assert(bfs::path(fileName.asChar()).parent_path() == m_projectPath);
+
+            m_fileName = fileName;
+            m_project->set_path(m_fileName.asChar());
+        }
+
         void exportProject()
         {
+            m_stats.reset(new ExportStatistics());
+
             exportDefaultRenderGlobals();
             MObject globalsNode = exportAppleseedRenderGlobals();
 
@@ -426,20 +530,8 @@ namespace
 
             exportScene(motionBlurSampleTimes);
 
-            // Set the shutter open and close times in all cameras.
-            asr::CameraContainer& cameras = m_project->get_scene()->cameras();
-
-            const float shutterOpenTime = motionBlurSampleTimes.normalizedFrame(motionBlurSampleTimes.m_shutterOpenTime);
-            const float shutterCloseTime = motionBlurSampleTimes.normalizedFrame(motionBlurSampleTimes.m_shutterCloseTime);
-
-            for (size_t i = 0, e = cameras.size(); i < e; ++i)
-            {
-                cameras.get_by_index(i)->get_parameters()
-                    .insert("shutter_open_begin_time", shutterOpenTime)
-                    .insert("shutter_open_end_time", shutterOpenTime)
-                    .insert("shutter_close_begin_time", shutterCloseTime)
-                    .insert("shutter_close_end_time", shutterCloseTime);
-            }
+            m_shutterOpenTime = motionBlurSampleTimes.normalizedFrame(motionBlurSampleTimes.m_shutterOpenTime);
+            m_shutterCloseTime = motionBlurSampleTimes.normalizedFrame(motionBlurSampleTimes.m_shutterCloseTime);
 
             asr::ParamArray params = m_project->get_frame()->get_parameters();
 
@@ -508,30 +600,22 @@ namespace
             MFnDependencyNode fnDepNode(globalsNode);
 
             // Apply the scene scale factor.
-            float sceneScale;
-            if (AttributeUtils::get(fnDepNode, "sceneScale", sceneScale))
+            m_sceneScale = 1.0f;
+            AttributeUtils::get(fnDepNode, "sceneScale", m_sceneScale);
+
+            asr::Scene* scene = m_project->get_scene();
+            if (m_sceneScale != 1.0f)
             {
-                if (sceneScale != 1.0f)
-                {
-                    asr::TransformSequence scaleTransformSeq;
-                    scaleTransformSeq.set_transform(0.0, asf::Transformd::from_local_to_parent(
-                        asf::Matrix4d::make_scaling(asf::Vector3d(sceneScale))));
-
-                    // Scale the main assembly instance.
-                    asr::Scene* scene = m_project->get_scene();
-                    asr::AssemblyInstance* assemblyInstance =
-                        scene->assembly_instances().get_by_name("assembly_inst");
-                    assemblyInstance->transform_sequence() = scaleTransformSeq;
-
-                    // Apply the scale to all cameras.
-                    for (size_t i = 0, e = scene->cameras().size(); i < e; ++i)
-                    {
-                        asr::Camera* camera = scene->cameras().get_by_index(i);
-                        camera->transform_sequence() = camera->transform_sequence() * scaleTransformSeq;
-                    }
-                }
+                // Scale the main assembly instance.
+                asr::AssemblyInstance* assemblyInstance =
+                    scene->assembly_instances().get_by_name("assembly_inst");
+                assemblyInstance->transform_sequence() = sceneScaleTransform();
             }
 
+            // Set the shutter times and apply the scale to all cameras.
+            for (size_t i = 0, e = scene->cameras().size(); i < e; ++i)
+                setupCamera(*scene->cameras().get_by_index(i));
+
             // Set the resolution.
             params.insert("resolution", asf::Vector2i(m_options.m_width, m_options.m_height));
 
@@ -547,6 +631,77 @@ namespace
                         asf::Vector2u(m_options.m_xmin, m_options.m_ymin),
                         asf::Vector2u(m_options.m_xmax, m_options.m_ymax)));
             }
+
+            finishStatistics(globalsNode);
+        }
+
+        asr::TransformSequence sceneScaleTransform() const
+        {
+            asr::TransformSequence scaleTransformSeq;
+            scaleTransformSeq.set_transform(0.0, asf::Transformd::from_local_to_parent(
+                asf::Matrix4d::make_scaling(asf::Vector3d(m_sceneScale))));
+            return scaleTransformSeq;
+        }
+
+        // Set the shutter open and close times and apply the scene scale factor.
+        // Cameras exported again in interactive sessions have to be set up again.
+        void setupCamera(asr::Camera& camera) const
+        {
+            camera.get_parameters()
+                .insert("shutter_open_begin_time", m_shutterOpenTime)
+                .insert("shutter_open_end_time", m_shutterOpenTime)
+                .insert("shutter_close_begin_time", m_shutterCloseTime)
+                .insert("shutter_close_end_time", m_shutterCloseTime);
+
+            if (m_sceneScale != 1.0f)
+                camera.transform_sequence() = camera.transform_sequence() * sceneScaleTransform();
+        }
+
+        const char* sessionModeName() const
+        {
+            switch (m_sessionMode)
+            {
+                case AppleseedSession::ExportSession:
+                    return "export";
+                case AppleseedSession::FinalRenderSession:
+                    return "finalRender";
+                case AppleseedSession::BatchRenderSession:
+                    return "batchRender";
+                case AppleseedSession::ProgressiveRenderSession:
+                    return "progressiveRender";
+                default:
+                    return "none";
+            }
+        }
+
+        void finishStatistics(const MObject& globalsNode)
+        {
+            m_stats->finish(sessionModeName(), m_fileName.asChar());
+
+            const std::string report = m_stats->toJSON();
+            ExportStatisticsReport::setLastReport(report);
+
+            if (!ExportStatisticsReport::writeReportsEnabled())
+                return;
+
+            // Write the report next to the project file or to the log file.
+            bfs::path reportPath;
+            if (m_sessionMode == AppleseedSession::ExportSession)
+                reportPath = m_fileName.asChar();
+            else
+                reportPath = RenderGlobalsNode::logFilename(globalsNode).asChar();
+
+            if (reportPath.empty())
+                return;
+
+            reportPath.replace_extension(".stats.json");
+
+            if (!m_stats->writeJSON(reportPath.string()))
+            {
+                RENDERER_LOG_WARNING(
+                    "Could not write export statistics to %s",
+                    reportPath.string().c_str());
+            }
         }
 
         bool autoInstancingEnabled() const
@@ -560,37 +715,283 @@ namespace
 
         void exportScene(const AppleseedSession::MotionBlurSampleTimes& motionBlurSampleTimes)
         {
-            createExporters();
-            throwIfUserAborted();
+            if (m_persistent && m_sceneExported)
+            {
+                exportAnimatedNodes(motionBlurSampleTimes);
+                return;
+            }
 
-            RENDERER_LOG_DEBUG("Creating alpha map entities");
-            for (auto it = m_alphaMapExporters.begin(), e = m_alphaMapExporters.end(); it != e; ++it)
-                it->second->createEntities();
+            clearNewExporters();
+            m_flushedShaderGroups.clear();
+
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "createExporters");
+                createExporters();
+            }
 
             throwIfUserAborted();
 
-            RENDERER_LOG_DEBUG("Creating shading network entities");
-            for (size_t i = 0; i < NumShadingNetworkContexts; ++i)
             {
-                for (auto it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
+                ExportStatistics::ScopedPhase phase(*m_stats, "createAlphaMapEntities");
+                RENDERER_LOG_DEBUG("Creating alpha map entities");
+                for (auto it = m_alphaMapExporters.begin(), e = m_alphaMapExporters.end(); it != e; ++it)
                     it->second->createEntities();
             }
 
-            RENDERER_LOG_DEBUG("Creating shading engine entities");
-            for (auto it = m_shadingEngineExporters.begin(), e = m_shadingEngineExporters.end(); it != e; ++it)
-                it->second->createEntities(m_options);
+            m_stats->addPhaseValue("count", static_cast<double>(m_alphaMapExporters.size()));
 
             throwIfUserAborted();
 
-            RENDERER_LOG_DEBUG("Creating dag entities");
+            size_t shadingNetworkCount = 0;
+            size_t foldedLayers = 0;
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "createShadingNetworkEntities");
+                RENDERER_LOG_DEBUG("Creating shading network entities");
+                for (size_t i = 0; i < NumShadingNetworkContexts; ++i)
+                {
+                    for (auto it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
+                    {
+                        it->second->createEntities();
+                        foldedLayers += it->second->foldedLayerCount();
+                    }
+
+                    shadingNetworkCount += m_shadingNetworkExporters[i].size();
+                }
+            }
+
+            m_stats->addPhaseValue("count", static_cast<double>(shadingNetworkCount));
+            m_stats->addPhaseValue("foldedLayers", static_cast<double>(foldedLayers));
+
+            if (foldedLayers != 0)
+            {
+                RENDERER_LOG_INFO(
+                    "Removed %s shader layers by folding constant utility nodes.",
+                    asf::pretty_uint(foldedLayers).c_str());
+            }
+
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "createShadingEngineEntities");
+                RENDERER_LOG_DEBUG("Creating shading engine entities");
+                for (auto it = m_shadingEngineExporters.begin(), e = m_shadingEngineExporters.end(); it != e; ++it)
+                    it->second->createEntities(m_options);
+            }
+
+            m_stats->addPhaseValue("count", static_cast<double>(m_shadingEngineExporters.size()));
+
+            throwIfUserAborted();
+
+            createDagEntities(m_dagExporters, motionBlurSampleTimes);
+
+            exportMotionSteps(m_dagExporters, motionBlurSampleTimes);
+
+            buildDagEntities(m_dagExporters);
+            throwIfUserAborted();
+
+            if (autoInstancingEnabled())
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "convertObjectsToInstances");
+                RENDERER_LOG_DEBUG("Converting objects to instances");
+                convertObjectsToInstances();
+            }
+
+            throwIfUserAborted();
+
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "flushAlphaMapEntities");
+                RENDERER_LOG_DEBUG("Flushing alpha map entities");
+                for (auto it = m_alphaMapExporters.begin(), e = m_alphaMapExporters.end(); it != e; ++it)
+                    it->second->flushEntities();
+            }
+
+            throwIfUserAborted();
+
+            size_t sharedShaderGroups = 0;
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "flushShadingNetworkEntities");
+                RENDERER_LOG_DEBUG("Flushing shading network entities");
+
+                std::vector<ShadingNetworkExporterPtr> networkExporters;
+                for (size_t i = 0; i < NumShadingNetworkContexts; ++i)
+                {
+                    for (auto it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
+                        networkExporters.push_back(it->second);
+                }
+
+                sharedShaderGroups = flushShadingNetworkEntities(networkExporters);
+            }
+
+            m_stats->addPhaseValue("sharedShaderGroups", static_cast<double>(sharedShaderGroups));
+
+            throwIfUserAborted();
+
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "flushShadingEngineEntities");
+                RENDERER_LOG_DEBUG("Flushing shading engines entities");
+                for (auto it = m_shadingEngineExporters.begin(), e = m_shadingEngineExporters.end(); it != e; ++it)
+                    it->second->flushEntities();
+            }
+
+            throwIfUserAborted();
+
+            flushDagEntities(m_dagExporters);
+
+            clearNewExporters();
+            m_sceneExported = true;
+        }
+
+        void exportAnimatedNodes(const AppleseedSession::MotionBlurSampleTimes& motionBlurSampleTimes)
+        {
+            RENDERER_LOG_DEBUG("Re-creating animated dag node exporters");
+
+            std::vector<MDagPath> paths;
             for (auto it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
-                it->second->createEntities(m_options, motionBlurSampleTimes);
+            {
+                if (needsExportEveryFrame(it->second->dagPath()))
+                    paths.push_back(it->second->dagPath());
+            }
+
+            // Animated nodes that were not renderable in previous frames.
+            paths.insert(paths.end(), m_skippedAnimatedPaths.begin(), m_skippedAnimatedPaths.end());
+            m_skippedAnimatedPaths.clear();
+
+            DagExporterMap animatedExporters;
+            exportDagNodesAgain(paths, motionBlurSampleTimes, animatedExporters);
+        }
+
+        // Replace the exporters of some dag nodes by new ones and export them again.
+        // Shading engines, networks and alpha maps already exported are reused.
+        void exportDagNodesAgain(
+            const std::vector<MDagPath>&                    paths,
+            const AppleseedSession::MotionBlurSampleTimes&  motionBlurSampleTimes,
+            DagExporterMap&                                 newExporters)
+        {
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "createExporters");
+
+                // The old exporters remove their entities from the project when destroyed.
+                for (size_t i = 0, e = paths.size(); i < e; ++i)
+                    m_dagExporters.erase(paths[i].fullPathName());
+
+                for (size_t i = 0, e = paths.size(); i < e; ++i)
+                {
+                    DagNodeExporterPtr exporter = createDagNodeExporter(paths[i]);
+                    if (exporter)
+                        newExporters[paths[i].fullPathName()] = exporter;
+                }
+
+                RENDERER_LOG_DEBUG("Creating dag extra exporters");
+                for (auto it = newExporters.begin(), e = newExporters.end(); it != e; ++it)
+                    it->second->createExporters(m_exporter_factory);
+
+                // Only export the shading engines seen for the first time.
+                RENDERER_LOG_DEBUG("Creating shading engines extra exporters");
+                for (size_t i = 0; i < m_newShadingEngineExporters.size(); ++i)
+                    m_newShadingEngineExporters[i]->createExporters(m_exporter_factory);
+            }
+
+            throwIfUserAborted();
+
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "createShadingEntities");
+
+                RENDERER_LOG_DEBUG("Creating alpha map entities");
+                for (size_t i = 0, e = m_newAlphaMapExporters.size(); i < e; ++i)
+                    m_newAlphaMapExporters[i]->createEntities();
+
+                RENDERER_LOG_DEBUG("Creating shading network entities");
+                for (size_t i = 0, e = m_newShadingNetworkExporters.size(); i < e; ++i)
+                    m_newShadingNetworkExporters[i]->createEntities();
+
+                RENDERER_LOG_DEBUG("Creating shading engine entities");
+                for (size_t i = 0, e = m_newShadingEngineExporters.size(); i < e; ++i)
+                    m_newShadingEngineExporters[i]->createEntities(m_options);
+            }
+
+            throwIfUserAborted();
+
+            createDagEntities(newExporters, motionBlurSampleTimes);
+
+            exportMotionSteps(newExporters, motionBlurSampleTimes);
+
+            buildDagEntities(newExporters);
+            throwIfUserAborted();
+
+            size_t sharedShaderGroups = 0;
+            {
+                ExportStatistics::ScopedPhase phase(*m_stats, "flushShadingEntities");
+
+                RENDERER_LOG_DEBUG("Flushing alpha map entities");
+                for (size_t i = 0, e = m_newAlphaMapExporters.size(); i < e; ++i)
+                    m_newAlphaMapExporters[i]->flushEntities();
+
+                RENDERER_LOG_DEBUG("Flushing shading network entities");
+                sharedShaderGroups = flushShadingNetworkEntities(m_newShadingNetworkExporters);
+
+                RENDERER_LOG_DEBUG("Flushing shading engines entities");
+                for (size_t i = 0, e = m_newShadingEngineExporters.size(); i < e; ++i)
+                    m_newShadingEngineExporters[i]->flushEntities();
+            }
 
+            m_stats->addPhaseValue("sharedShaderGroups", static_cast<double>(sharedShaderGroups));
+
+            throwIfUserAborted();
+
+            flushDagEntities(newExporters);
+
+            clearNewExporters();
+        }
+
+        // Return the Maya node type of each dag exporter, for statistics.
+        std::vector<std::pair<DagNodeExporter*, std::string>> exportersWithType(
+            const DagExporterMap&                           exporters) const
+        {
+            std::vector<std::pair<DagNodeExporter*, std::string>> result;
+            result.reserve(exporters.size());
+
+            MFnDependencyNode depNodeFn;
+            for (auto it = exporters.begin(), e = exporters.end(); it != e; ++it)
+            {
+                depNodeFn.setObject(it->second->node());
+                result.push_back(std::make_pair(it->second.get(), std::string(depNodeFn.typeName().asChar())));
+            }
+
+            return result;
+        }
+
+        void createDagEntities(
+            const DagExporterMap&                           dagExporters,
+            const AppleseedSession::MotionBlurSampleTimes&  motionBlurSampleTimes)
+        {
+            ExportStatistics::ScopedPhase phase(*m_stats, "createDagEntities");
+            RENDERER_LOG_DEBUG("Creating dag entities");
+
+            const auto exporters = exportersWithType(dagExporters);
+            for (size_t i = 0, e = exporters.size(); i < e; ++i)
+            {
+                const auto start = ExportStatistics::Clock::now();
+                exporters[i].first->createEntities(m_options, motionBlurSampleTimes);
+
+                m_stats->addExporter(exporters[i].second);
+                m_stats->addExporterTime(
+                    exporters[i].second,
+                    "createEntities",
+                    ExportStatistics::secondsSince(start));
+            }
+        }
+
+        void exportMotionSteps(
+            const DagExporterMap&                           dagExporters,
+            const AppleseedSession::MotionBlurSampleTimes&  motionBlurSampleTimes)
+        {
             RENDERER_LOG_DEBUG("Exporting motion steps");
+
+            const auto exporters = exportersWithType(dagExporters);
+
             auto frameIt(motionBlurSampleTimes.m_allTimes.begin());
             auto frameEnd(motionBlurSampleTimes.m_allTimes.end());
             for (; frameIt != frameEnd; ++frameIt)
             {
+                const auto stepStart = ExportStatistics::Clock::now();
                 const float now = static_cast<float>(MAnimControl::currentTime().value());
 
                 if (*frameIt != now)
@@ -599,58 +1000,165 @@ namespace
                     MGlobal::viewFrame(*frameIt);
                 }
 
+                const double viewFrameTime = ExportStatistics::secondsSince(stepStart);
                 const float frame = motionBlurSampleTimes.normalizedFrame(*frameIt);
 
-                for (auto it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
+                for (size_t i = 0, e = exporters.size(); i < e; ++i)
                 {
-                    if (it->second->supportsMotionBlur())
+                    DagNodeExporter* exporter = exporters[i].first;
+
+                    if (exporter->supportsMotionBlur())
                     {
+                        const auto start = ExportStatistics::Clock::now();
+
                         if (motionBlurSampleTimes.m_cameraTimes.count(*frameIt))
-                            it->second->exportCameraMotionStep(frame);
+                            exporter->exportCameraMotionStep(frame);
 
                         if (motionBlurSampleTimes.m_transformTimes.count(*frameIt))
-                            it->second->exportTransformMotionStep(frame);
+                            exporter->exportTransformMotionStep(frame);
 
                         if (motionBlurSampleTimes.m_deformTimes.count(*frameIt))
-                            it->second->exportShapeMotionStep(frame);
+                            exporter->exportShapeMotionStep(frame);
+
+                        m_stats->addExporterTime(
+                            exporters[i].second,
+                            "motionSteps",
+                            ExportStatistics::secondsSince(start));
                     }
 
                     throwIfUserAborted();
                 }
+
+                m_stats->addPhase("motionStep", ExportStatistics::secondsSince(stepStart));
+                m_stats->addPhaseValue("frame", *frameIt);
+                m_stats->addPhaseValue("viewFrameTime", viewFrameTime);
             }
+        }
 
-            if (autoInstancingEnabled())
+        void buildDagEntities(const DagExporterMap& dagExporters)
+        {
+            ExportStatistics::ScopedPhase phase(*m_stats, "buildDagEntities");
+            RENDERER_LOG_DEBUG("Building dag entities");
+
+            const auto exporters = exportersWithType(dagExporters);
+            std::vector<double> times(exporters.size(), 0.0);
+
+            Parallel::parallelFor(
+                exporters.size(),
+                [&exporters, &times](const size_t i)
+                {
+                    Tracer::ScopedEvent event("export", exporters[i].second);
+                    const auto start = ExportStatistics::Clock::now();
+                    exporters[i].first->buildEntities();
+                    times[i] = ExportStatistics::secondsSince(start);
+                });
+
+            for (size_t i = 0, e = exporters.size(); i < e; ++i)
             {
-                RENDERER_LOG_DEBUG("Converting objects to instances");
-                convertObjectsToInstances();
+                m_stats->addExporterTime(exporters[i].second, "buildEntities", times[i]);
+                m_stats->addGeometryBytes(exporters[i].first->geometrySize());
             }
+        }
 
-            throwIfUserAborted();
+        void flushDagEntities(const DagExporterMap& dagExporters)
+        {
+            ExportStatistics::ScopedPhase phase(*m_stats, "flushDagEntities");
+            RENDERER_LOG_DEBUG("Flushing dag entities");
 
-            RENDERER_LOG_DEBUG("Flushing alpha map entities");
-            for (auto it = m_alphaMapExporters.begin(), e = m_alphaMapExporters.end(); it != e; ++it)
-                it->second->flushEntities();
+            const auto exporters = exportersWithType(dagExporters);
+            for (size_t i = 0, e = exporters.size(); i < e; ++i)
+            {
+                const auto start = ExportStatistics::Clock::now();
+                exporters[i].first->flushEntities();
 
-            throwIfUserAborted();
+                m_stats->addExporterTime(
+                    exporters[i].second,
+                    "flushEntities",
+                    ExportStatistics::secondsSince(start));
+            }
+        }
+
+        // Flush shading networks. Outside of progressive sessions, where
+        // networks are edited independently, networks with the same content share
+        // a single shader group. Return the number of shared shader groups.
+        size_t flushShadingNetworkEntities(const std::vector<ShadingNetworkExporterPtr>& exporters)
+        {
+            if (m_sessionMode == AppleseedSession::ProgressiveRenderSession)
+            {
+                for (size_t i = 0, e = exporters.size(); i < e; ++i)
+                    exporters[i]->flushEntities();
+
+                return 0;
+            }
 
-            RENDERER_LOG_DEBUG("Flushing shading network entities");
+            size_t sharedShaderGroups = 0;
+            for (size_t i = 0, e = exporters.size(); i < e; ++i)
+            {
+                if (exporters[i]->flushEntities(m_flushedShaderGroups))
+                    ++sharedShaderGroups;
+            }
+
+            if (sharedShaderGroups != 0)
+            {
+                RENDERER_LOG_INFO(
+                    "%s shading networks share the shader group of an identical network.",
+                    asf::pretty_uint(sharedShaderGroups).c_str());
+            }
+
+            return sharedShaderGroups;
+        }
+
+        void clearNewExporters()
+        {
+            m_newAlphaMapExporters.clear();
+            m_newShadingNetworkExporters.clear();
+            m_newShadingEngineExporters.clear();
+        }
+
+        // Return true if a shading network or an alpha map changes over time.
+        // Persistent sessions only export them for the first frame.
+        bool hasAnimatedShading() const
+        {
             for (size_t i = 0; i < NumShadingNetworkContexts; ++i)
             {
                 for (auto it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
-                    it->second->flushEntities();
+                {
+                    const MObjectArray nodes = it->second->nodes();
+                    for (unsigned int j = 0, je = nodes.length(); j < je; ++j)
+                    {
+                        if (isShadingNodeAnimated(nodes[j]))
+                            return true;
+                    }
+                }
             }
 
-            throwIfUserAborted();
+            for (auto it = m_alphaMapExporters.begin(), e = m_alphaMapExporters.end(); it != e; ++it)
+            {
+                if (isShadingNodeAnimated(it->second->node()))
+                    return true;
+            }
 
-            RENDERER_LOG_DEBUG("Flushing shading engines entities");
-            for (auto it = m_shadingEngineExporters.begin(), e = m_shadingEngineExporters.end(); it != e; ++it)
-                it->second->flushEntities();
+            return false;
+        }
 
-            throwIfUserAborted();
+        // Return true if the node has to be exported again for every frame
+        // of a persistent sequence export. The result is cached per node.
+        bool needsExportEveryFrame(const MDagPath& path)
+        {
+            const MString name = path.fullPathName();
 
-            RENDERER_LOG_DEBUG("Flushing dag entities");
-            for (auto it = m_dagExporters.begin(), e = m_dagExporters.end(); it != e; ++it)
-                it->second->flushEntities();
+            auto it = m_animatedNodes.find(name);
+            if (it != m_animatedNodes.end())
+                return it->second;
+
+            // Cameras are always exported, the scene scale
+            // factor is applied to them after every export.
+            const bool animated =
+                path.node().hasFn(MFn::kCamera) ||
+                DagNodeExporter::isAnimated(path.node(), true);
+
+            m_animatedNodes[name] = animated;
+            return animated;
         }
 
         void exportDefaultRenderGlobals()
@@ -668,6 +1176,9 @@ namespace
         {
             RENDERER_LOG_DEBUG("Exporting appleseed render globals");
 
+            // AOVs are recreated for every frame.
+            m_aovs.clear();
+
             MObject appleseedRenderGlobalsNode;
             if (getDependencyNodeByName("appleseedRenderGlobals", appleseedRenderGlobalsNode))
             {
@@ -737,22 +1248,22 @@ namespace
                 it->second->createExporters(m_exporter_factory);
         }
 
-        void createDagNodeExporter(const MDagPath& path)
+        DagNodeExporterPtr createDagNodeExporter(const MDagPath& path)
         {
             throwIfUserAborted();
 
             if (m_dagExporters.count(path.fullPathName()) != 0)
-                return;
+                return DagNodeExporterPtr();
 
             MFnDagNode dagNodeFn(path);
 
             // Avoid warnings about missing exporter for transform nodes.
             if (dagNodeFn.typeName() == "transform")
-                return;
+                return DagNodeExporterPtr();
 
             // Skip Maya's world node.
             if (dagNodeFn.typeName() == "dagNode" && dagNodeFn.name() == "world")
-                return;
+                return DagNodeExporterPtr();
 
             DagNodeExporterPtr exporter;
 
@@ -769,16 +1280,27 @@ namespace
                     "No dag exporter found for node %s of type %s",
                     dagNodeFn.name().asChar(),
                     dagNodeFn.typeName().asChar());
-                return;
+                return DagNodeExporterPtr();
             }
 
             if (exporter)
             {
+                // Animated nodes are replaced in place in the next frames.
+                if (m_persistent && needsExportEveryFrame(path))
+                    exporter->setRemoveEntitiesOnDestruction();
+
                 m_dagExporters[path.fullPathName()] = exporter;
                 RENDERER_LOG_DEBUG(
                     "Created dag exporter for node %s",
                     dagNodeFn.name().asChar());
             }
+            else if (m_persistent && needsExportEveryFrame(path))
+            {
+                // The node may become renderable later in the sequence.
+                m_skippedAnimatedPaths.push_back(path);
+            }
+
+            return exporter;
         }
 
         void convertObjectsToInstances()
@@ -790,6 +1312,11 @@ namespace
                 ShapeExporter* shape = dynamic_cast<ShapeExporter*>(it->second.get());
                 if (shape && shape->supportsInstancing())
                 {
+                    // Animated shapes are replaced in the next frames of
+                    // a persistent export, they can't be used as masters.
+                    if (m_persistent && needsExportEveryFrame(shape->dagPath()))
+                        continue;
+
                     // Compute the object hash.
                     MurmurHash hash = shape->hash();
                     RENDERER_LOG_DEBUG(
@@ -849,85 +1376,459 @@ namespace
             getDependencyNodeByName("appleseedRenderGlobals", appleseedRenderGlobalsNode);
             MFnDependencyNode depNodeFn(appleseedRenderGlobalsNode);
 
-            // Init logging.
-            asr::global_logger().set_verbosity_level(
-                RenderGlobalsNode::logLevel(appleseedRenderGlobalsNode));
+            // Init logging.
+            asr::global_logger().set_verbosity_level(
+                RenderGlobalsNode::logLevel(appleseedRenderGlobalsNode));
+
+            // Start the idle job queue for render view updates.
+            IdleJobQueue::start();
+
+            // Reset the renderer controller.
+            m_rendererController.set_status(asr::IRendererController::ContinueRendering);
+
+            // Create a tile callback to render to Maya's render view.
+            m_tileCallbackFactory.reset(
+                new RenderViewTileCallbackFactory(m_rendererController, m_computation));
+            m_tileCallbackFactory->renderViewStart(*m_project->get_frame());
+
+            // Create the master renderer.
+            asr::Configuration* cfg = m_project->configurations().get_by_name("final");
+            const asr::ParamArray& params = cfg->get_parameters();
+            m_renderer.reset(
+                new asr::MasterRenderer(
+                    *m_project,
+                    params,
+                    g_resourceSearchPaths,
+                    static_cast<asr::ITileCallbackFactory*>(m_tileCallbackFactory.get())));
+
+            // Render in a thread (non blocking).
+            std::thread thread(&SessionImpl::renderFunc, this);
+            m_renderThread.swap(thread);
+        }
+
+        void batchRender()
+        {
+            // Get the appleseed globals node.
+            MObject appleseedRenderGlobalsNode;
+            getDependencyNodeByName("appleseedRenderGlobals", appleseedRenderGlobalsNode);
+            MFnDependencyNode depNodeFn(appleseedRenderGlobalsNode);
+
+            // Init logging.
+            ScopedSetLoggerVerbosity logLevel(RenderGlobalsNode::logLevel(appleseedRenderGlobalsNode));
+
+            ScopedLogTarget logTarget;
+            initFileLogging(appleseedRenderGlobalsNode, logTarget);
+
+            // Reset the renderer controller.
+            m_rendererController.set_status(asr::IRendererController::ContinueRendering);
+
+            // Create the master renderer.
+            asr::Configuration* cfg = m_project->configurations().get_by_name("final");
+            const asr::ParamArray& params = cfg->get_parameters();
+            m_renderer.reset(
+                new asr::MasterRenderer(
+                    *m_project,
+                    params,
+                    g_resourceSearchPaths,
+                    static_cast<asr::ITileCallbackFactory*>(nullptr)));
+
+            // Render in the main thread (blocking).
+            m_renderer->render(m_rendererController);
+        }
+
+        void progressiveRender()
+        {
+            assert(MGlobal::mayaState() == MGlobal::kInteractive);
+
+            // Get the appleseed globals node.
+            MObject appleseedRenderGlobalsNode;
+            getDependencyNodeByName("appleseedRenderGlobals", appleseedRenderGlobalsNode);
+
+            // Init logging.
+            asr::global_logger().set_verbosity_level(
+                RenderGlobalsNode::logLevel(appleseedRenderGlobalsNode));
+
+            // The computation is only used to interrupt the export.
+            // Interactive renders are stopped from the render view.
+            m_computation.reset();
+
+            // Start the idle job queue for render view updates and scene edits.
+            IdleJobQueue::start();
+
+            // Create a tile callback to render to Maya's render view.
+            m_tileCallbackFactory.reset(
+                new RenderViewTileCallbackFactory(m_rendererController, m_computation));
+            m_tileCallbackFactory->renderViewStart(*m_project->get_frame());
+
+            // Create the master renderer.
+            asr::Configuration* cfg = m_project->configurations().get_by_name("interactive");
+            const asr::ParamArray& params = cfg->get_parameters();
+            m_renderer.reset(
+                new asr::MasterRenderer(
+                    *m_project,
+                    params,
+                    g_resourceSearchPaths,
+                    static_cast<asr::ITileCallbackFactory*>(m_tileCallbackFactory.get())));
+
+            // Watch the exported nodes for edits.
+            m_editTracker.reset(new SceneEditTracker(&applySceneEdits));
+
+            if (!appleseedRenderGlobalsNode.isNull())
+                m_editTracker->watchNode(appleseedRenderGlobalsNode, SceneEditTracker::RenderGlobalsNode);
+
+            watchDagNodes(m_dagExporters);
+            watchShadingNodes();
+
+            startRenderThread();
+        }
+
+        void pauseProgressiveRender(const bool pause)
+        {
+            assert(m_sessionMode == AppleseedSession::ProgressiveRenderSession);
+
+            m_paused = pause;
+            m_rendererController.set_status(
+                m_paused
+                    ? asr::IRendererController::PauseRendering
+                    : asr::IRendererController::ContinueRendering);
+        }
+
+        // Apply the scene edits made since the last restart of the interactive render.
+        // Return false if the edits require exporting the whole scene again.
+        bool applySceneEdits()
+        {
+            assert(m_editTracker);
+
+            SceneEditTracker::Edits edits;
+            m_editTracker->takeEdits(edits);
+
+            if (edits.empty())
+                return true;
+
+            if (edits.m_renderGlobalsChanged)
+                return false;
+
+            Tracer::ScopedEvent event("export", "applySceneEdits");
+            const auto start = ExportStatistics::Clock::now();
+
+            // Entities can't be edited while rendering.
+            abortRender();
+
+            m_stats.reset(new ExportStatistics());
+
+            for (size_t i = 0, e = edits.m_removedDagPaths.size(); i < e; ++i)
+                removeDagExporters(edits.m_removedDagPaths[i]);
+
+            for (size_t i = 0, e = edits.m_removedShadingEngines.size(); i < e; ++i)
+                m_shadingEngineExporters.erase(edits.m_removedShadingEngines[i]);
+
+            // Shading networks and shading engines are exported again in place,
+            // the entities referencing them by name don't need to be updated.
+            const size_t updatedNetworkCount =
+                updateShadingNetworks(edits.m_dirtyShadingNodes, edits.m_editedShadingNodes);
+            updateShadingEngines(edits.m_dirtyShadingEngines);
+
+            // Dag nodes get new exporters.
+            std::map<MString, MDagPath, MStringCompareLess> pathMap;
+            collectDagPaths(edits.m_dirtyDagNodes, false, pathMap);
+            collectDagPaths(edits.m_dirtyTransforms, true, pathMap);
+            collectDagPaths(edits.m_addedDagNodes, true, pathMap);
+
+            // Moved nodes only get their transforms updated.
+            std::map<MString, MDagPath, MStringCompareLess> movedPathMap;
+            collectDagPaths(edits.m_movedDagNodes, false, movedPathMap);
+            collectDagPaths(edits.m_movedTransforms, true, movedPathMap);
+
+            size_t movedCount = 0;
+            for (auto it = movedPathMap.begin(), e = movedPathMap.end(); it != e; ++it)
+            {
+                if (pathMap.count(it->first) != 0)
+                    continue;
+
+                auto exporterIt = m_dagExporters.find(it->first);
+                if (exporterIt == m_dagExporters.end())
+                    continue;
+
+                if (updateTransform(*exporterIt->second))
+                    ++movedCount;
+                else
+                    pathMap[it->first] = it->second;
+            }
+
+            std::vector<MDagPath> paths;
+            for (auto it = pathMap.begin(), e = pathMap.end(); it != e; ++it)
+                paths.push_back(it->second);
+
+            DagExporterMap newExporters;
+            if (!paths.empty())
+            {
+                AppleseedSession::MotionBlurSampleTimes motionBlurSampleTimes;
+                motionBlurSampleTimes.initializeToCurrentFrame();
+
+                exportDagNodesAgain(paths, motionBlurSampleTimes, newExporters);
+
+                for (auto it = newExporters.begin(), e = newExporters.end(); it != e; ++it)
+                    setupExportedCamera(*it->second);
+            }
+
+            // Watch the nodes seen for the first time.
+            watchDagNodes(newExporters);
+            watchShadingNodes();
+
+            // Exporting can dirty the nodes we just exported.
+            m_editTracker->discardEdits();
+
+            m_tileCallbackFactory->measureEditLatency(edits.m_time);
+
+            startRenderThread();
+
+            RENDERER_LOG_DEBUG(
+                "Applied scene edits in %.1f ms, %s shading networks updated, %s dag nodes moved, %s dag nodes exported again",
+                ExportStatistics::secondsSince(start) * 1000.0,
+                asf::pretty_uint(updatedNetworkCount).c_str(),
+                asf::pretty_uint(movedCount).c_str(),
+                asf::pretty_uint(newExporters.size()).c_str());
+
+            return true;
+        }
+
+        // Update the transform of a moved dag node without exporting it again.
+        bool updateTransform(DagNodeExporter& exporter)
+        {
+            if (!exporter.updateTransform())
+                return false;
+
+            setupExportedCamera(exporter);
+            return true;
+        }
+
+        // Set up the camera entity of a camera exporter, if any.
+        void setupExportedCamera(const DagNodeExporter& exporter)
+        {
+            if (exporter.node().hasFn(MFn::kCamera))
+            {
+                asr::Camera* camera =
+                    m_project->get_scene()->cameras().get_by_name(exporter.appleseedName().asChar());
+
+                if (camera)
+                    setupCamera(*camera);
+            }
+        }
+
+        // Remove the exporters of a dag path and of its children.
+        void removeDagExporters(const MString& pathName)
+        {
+            const std::string prefix = std::string(pathName.asChar()) + "|";
+
+            for (auto it = m_dagExporters.begin(); it != m_dagExporters.end();)
+            {
+                if (it->first == pathName || asf::starts_with(it->first.asChar(), prefix))
+                    it = m_dagExporters.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        // Collect the dag paths of edited nodes, and optionally of all their children.
+        void collectDagPaths(
+            const SceneEditTracker::NodeSet&                    nodes,
+            const bool                                          includeChildren,
+            std::map<MString, MDagPath, MStringCompareLess>&    paths) const
+        {
+            MDagPathArray nodePaths;
+            MDagPath path;
+            MItDag it(MItDag::kDepthFirst);
+
+            for (auto nodeIt = nodes.begin(), e = nodes.end(); nodeIt != e; ++nodeIt)
+            {
+                // Skip deleted nodes.
+                if (!nodeIt->second.isValid())
+                    continue;
+
+                MDagPath::getAllPathsTo(nodeIt->second.object(), nodePaths);
+
+                for (unsigned int i = 0, ie = nodePaths.length(); i < ie; ++i)
+                {
+                    if (!includeChildren)
+                    {
+                        paths[nodePaths[i].fullPathName()] = nodePaths[i];
+                        continue;
+                    }
+
+                    for (it.reset(nodePaths[i]); !it.isDone(); it.next())
+                    {
+                        if (it.getPath(path))
+                            paths[path.fullPathName()] = path;
+                    }
+                }
+            }
+        }
+
+        // Update the shading networks containing edited shading nodes.
+        // Networks with changed connections are exported again, parameter edits are
+        // applied to the existing shader groups. Return the number of networks updated
+        // without being exported again.
+        size_t updateShadingNetworks(
+            const SceneEditTracker::NodeSet&        dirtyNodes,
+            const SceneEditTracker::PlugEditMap&    editedNodes)
+        {
+            std::set<ShadingNetworkExporter*> networks;
+
+            for (auto nodeIt = dirtyNodes.begin(), e = dirtyNodes.end(); nodeIt != e; ++nodeIt)
+            {
+                if (nodeIt->second.isValid())
+                    findShadingNetworks(MFnDependencyNode(nodeIt->second.object()).name(), networks);
+            }
+
+            std::set<ShadingNetworkExporter*> updatedNetworks;
+
+            for (auto nodeIt = editedNodes.begin(), e = editedNodes.end(); nodeIt != e; ++nodeIt)
+            {
+                if (!nodeIt->second.m_node.isValid())
+                    continue;
+
+                const MString nodeName = MFnDependencyNode(nodeIt->second.m_node.object()).name();
+
+                std::set<ShadingNetworkExporter*> nodeNetworks;
+                findShadingNetworks(nodeName, nodeNetworks);
+
+                for (auto it = nodeNetworks.begin(), ie = nodeNetworks.end(); it != ie; ++it)
+                {
+                    if (networks.count(*it) != 0)
+                        continue;
+
+                    if ((*it)->updateShaderParameters(nodeName, nodeIt->second.m_plugs))
+                        updatedNetworks.insert(*it);
+                    else
+                    {
+                        updatedNetworks.erase(*it);
+                        networks.insert(*it);
+                    }
+                }
+            }
+
+            for (auto it = networks.begin(), e = networks.end(); it != e; ++it)
+            {
+                (*it)->removeEntities();
+                (*it)->createEntities();
+                (*it)->flushEntities();
+            }
+
+            return updatedNetworks.size();
+        }
+
+        // Collect the shading networks containing a shading node.
+        void findShadingNetworks(
+            const MString&                          nodeName,
+            std::set<ShadingNetworkExporter*>&      networks) const
+        {
+            for (size_t i = 0; i < NumShadingNetworkContexts; ++i)
+            {
+                for (auto it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
+                {
+                    if (it->second->containsNode(nodeName))
+                        networks.insert(it->second.get());
+                }
+            }
+        }
+
+        // Export again the edited shading engines, and the networks connected to them
+        // for the first time.
+        void updateShadingEngines(const SceneEditTracker::NodeSet& nodes)
+        {
+            std::vector<ShadingEngineExporterPtr> engines;
 
-            // Start the idle job queue for render view updates.
-            IdleJobQueue::start();
+            for (auto nodeIt = nodes.begin(), e = nodes.end(); nodeIt != e; ++nodeIt)
+            {
+                if (!nodeIt->second.isValid())
+                    continue;
 
-            // Reset the renderer controller.
-            m_rendererController.set_status(asr::IRendererController::ContinueRendering);
+                auto it = m_shadingEngineExporters.find(MFnDependencyNode(nodeIt->second.object()).name());
+                if (it != m_shadingEngineExporters.end())
+                    engines.push_back(it->second);
+            }
 
-            // Create a tile callback to render to Maya's render view.
-            m_tileCallbackFactory.reset(
-                new RenderViewTileCallbackFactory(m_rendererController, m_computation));
-            m_tileCallbackFactory->renderViewStart(*m_project->get_frame());
+            clearNewExporters();
 
-            // Create the master renderer.
-            asr::Configuration* cfg = m_project->configurations().get_by_name("final");
-            const asr::ParamArray& params = cfg->get_parameters();
-            m_renderer.reset(
-                new asr::MasterRenderer(
-                    *m_project,
-                    params,
-                    g_resourceSearchPaths,
-                    static_cast<asr::ITileCallbackFactory*>(m_tileCallbackFactory.get())));
+            for (size_t i = 0, e = engines.size(); i < e; ++i)
+            {
+                engines[i]->removeEntities();
+                engines[i]->createExporters(m_exporter_factory);
+            }
 
-            // Render in a thread (non blocking).
-            std::thread thread(&SessionImpl::renderFunc, this);
-            m_renderThread.swap(thread);
-        }
+            for (size_t i = 0, e = m_newShadingNetworkExporters.size(); i < e; ++i)
+                m_newShadingNetworkExporters[i]->createEntities();
 
-        void batchRender()
-        {
-            // Get the appleseed globals node.
-            MObject appleseedRenderGlobalsNode;
-            getDependencyNodeByName("appleseedRenderGlobals", appleseedRenderGlobalsNode);
-            MFnDependencyNode depNodeFn(appleseedRenderGlobalsNode);
+            for (size_t i = 0, e = engines.size(); i < e; ++i)
+                engines[i]->createEntities(m_options);
 
-            // Init logging.
-            ScopedSetLoggerVerbosity logLevel(RenderGlobalsNode::logLevel(appleseedRenderGlobalsNode));
+            for (size_t i = 0, e = m_newShadingNetworkExporters.size(); i < e; ++i)
+                m_newShadingNetworkExporters[i]->flushEntities();
 
-            ScopedLogTarget logTarget;
-            initFileLogging(appleseedRenderGlobalsNode, logTarget);
+            for (size_t i = 0, e = engines.size(); i < e; ++i)
+                engines[i]->flushEntities();
 
-            // Reset the renderer controller.
-            m_rendererController.set_status(asr::IRendererController::ContinueRendering);
+            clearNewExporters();
+        }
 
-            // Create the master renderer.
-            asr::Configuration* cfg = m_project->configurations().get_by_name("final");
-            const asr::ParamArray& params = cfg->get_parameters();
-            m_renderer.reset(
-                new asr::MasterRenderer(
-                    *m_project,
-                    params,
-                    g_resourceSearchPaths,
-                    static_cast<asr::ITileCallbackFactory*>(nullptr)));
+        // Watch dag nodes and their parent transforms for edits.
+        void watchDagNodes(const DagExporterMap& dagExporters)
+        {
+            for (auto it = dagExporters.begin(), e = dagExporters.end(); it != e; ++it)
+            {
+                MDagPath path = it->second->dagPath();
+                m_editTracker->watchNode(path.node(), SceneEditTracker::DagNode);
 
-            // Render in the main thread (blocking).
-            m_renderer->render(m_rendererController);
+                for (path.pop(); path.length() > 0; path.pop())
+                    m_editTracker->watchNode(path.node(), SceneEditTracker::TransformNode);
+            }
         }
 
-        void progressiveRender()
+        // Watch shading engines and shading network nodes for edits.
+        void watchShadingNodes()
         {
-            /*
-            // Reset the renderer controller.
-            m_rendererController->set_status(asr::IRendererController::ContinueRendering);
+            for (auto it = m_shadingEngineExporters.begin(), e = m_shadingEngineExporters.end(); it != e; ++it)
+                m_editTracker->watchNode(it->second->node(), SceneEditTracker::ShadingEngineNode);
 
-            // Create the master renderer.
-            asr::Configuration* cfg = m_project->configurations().get_by_name("interactive");
-            const asr::ParamArray &params = cfg->get_parameters();
+            for (size_t i = 0; i < NumShadingNetworkContexts; ++i)
+            {
+                for (auto it = m_shadingNetworkExporters[i].begin(), e = m_shadingNetworkExporters[i].end(); it != e; ++it)
+                {
+                    const MObjectArray nodes = it->second->nodes();
+                    for (unsigned int j = 0, je = nodes.length(); j < je; ++j)
+                        m_editTracker->watchNode(nodes[j], SceneEditTracker::ShadingNode);
+                }
+            }
+        }
 
-            RenderViewTileCallbackFactory tileCallbackFactory;
-            m_renderer.reset( new asr::MasterRenderer(*m_project, params, m_rendererController, &tileCallbackFactory));
-            */
+        void startRenderThread()
+        {
+            m_rendererController.set_status(
+                m_paused
+                    ? asr::IRendererController::PauseRendering
+                    : asr::IRendererController::ContinueRendering);
+
+            std::thread thread(&SessionImpl::renderFunc, this);
+            m_renderThread.swap(thread);
         }
 
         void renderFunc()
         {
-            m_renderer->render(m_rendererController);
-            IdleJobQueue::pushJob(&AppleseedSession::endSession);
+            Tracer::setThreadName("Render thread");
+
+            {
+                Tracer::ScopedEvent event("render", "render");
+                m_renderer->render(m_rendererController);
+            }
+
+            // Interactive sessions wait for scene edits until they are stopped.
+            // Retry while the idle job queue is full, unless the main thread
+            // is waiting for this thread: it is ending the session already.
+            if (m_sessionMode != AppleseedSession::ProgressiveRenderSession)
+            {
+                while (!IdleJobQueue::pushJob(&AppleseedSession::endSession) && !m_joiningRenderThread)
+                    std::this_thread::yield();
+            }
         }
 
         void abortRender()
@@ -937,7 +1838,11 @@ namespace
 
             // Wait for the render thread to finish.
             if (m_renderThread.joinable())
+            {
+                m_joiningRenderThread = true;
                 m_renderThread.join();
+                m_joiningRenderThread = false;
+            }
         }
 
         asf::AABB3d computeSceneBoundingBox() const
@@ -960,10 +1865,16 @@ namespace
         }
 
         bool writeProject(const char* filename) const
+        {
+            writeBoundingBox(filename);
+            return writeProjectFile(filename);
+        }
+
+        // Save the bounding box of the scene if needed. Needs the Maya API.
+        void writeBoundingBox(const char* filename) const
         {
             if (m_options.m_writeBoundingBox)
             {
-                // Save the bounding box of the scene.
                 asf::AABB3d bbox = computeSceneBoundingBox();
 
                 bfs::path path(filename);
@@ -974,6 +1885,13 @@ namespace
                     << bbox.min.x << ", " << bbox.min.y << ", " << bbox.min.z << ", "
                     << bbox.max.x << ", " << bbox.max.y << ", " << bbox.max.z << "]";
             }
+        }
+
+        // Write the project file. Does not use the Maya API and can be
+        // called from any thread once the project has been exported.
+        bool writeProjectFile(const char* filename) const
+        {
+            Tracer::ScopedEvent event("io", "writeProject");
 
             const bool packed = asf::ends_with(filename, ".appleseedz");
             return asr::ProjectFileWriter::write(
@@ -1003,12 +1921,6 @@ namespace
                 m_computation->thowIfInterruptRequested();
         }
 
-        typedef std::map<MString, DagNodeExporterPtr, MStringCompareLess>           DagExporterMap;
-        typedef std::map<MString, ShadingEngineExporterPtr, MStringCompareLess>     ShadingEngineExporterMap;
-        typedef std::map<MString, ShadingNetworkExporterPtr, MStringCompareLess>    ShadingNetworkExporterMap;
-        typedef std::array<ShadingNetworkExporterMap, NumShadingNetworkContexts>    ShadingNetworkExporterMapArray;
-        typedef std::map<MString, AlphaMapExporterPtr, MStringCompareLess>          AlphaMapExporterMap;
-
         AppleseedSession::SessionMode                           m_sessionMode;
         AppleseedSession::Options                               m_options;
         ComputationPtr                                          m_computation;
@@ -1026,11 +1938,144 @@ namespace
         ShadingNetworkExporterMapArray                          m_shadingNetworkExporters;
         AlphaMapExporterMap                                     m_alphaMapExporters;
 
+        // Exporters created since the last export, used by persistent sessions.
+        std::vector<ShadingEngineExporterPtr>                   m_newShadingEngineExporters;
+        std::vector<ShadingNetworkExporterPtr>                  m_newShadingNetworkExporters;
+        std::vector<AlphaMapExporterPtr>                        m_newAlphaMapExporters;
+
+        // Shader groups flushed so far, indexed by content hash.
+        ShadingNetworkExporter::ShaderGroupHashMap              m_flushedShaderGroups;
+
+        std::unique_ptr<ExportStatistics>                       m_stats;
+
+        float                                                   m_shutterOpenTime;
+        float                                                   m_shutterCloseTime;
+        float                                                   m_sceneScale;
+
+        bool                                                    m_persistent;
+        bool                                                    m_sceneExported;
+        std::map<MString, bool, MStringCompareLess>             m_animatedNodes;
+        std::vector<MDagPath>                                   m_skippedAnimatedPaths;
+
         std::unique_ptr<asr::MasterRenderer>                    m_renderer;
         RendererController                                      m_rendererController;
         asf::auto_release_ptr<RenderViewTileCallbackFactory>    m_tileCallbackFactory;
 
+        std::unique_ptr<SceneEditTracker>                       m_editTracker;
+        bool                                                    m_paused;
+
         std::thread                                             m_renderThread;
+        std::atomic<bool>                                       m_joiningRenderThread;
+    };
+
+    // Writes the projects of a sequence export in a background thread,
+    // while the main thread exports the next frames.
+    class ProjectWriter
+      : public asf::NonCopyable
+    {
+      public:
+        explicit ProjectWriter(const size_t maxPendingProjects)
+          : m_maxPendingProjects(std::max(maxPendingProjects, size_t(1)))
+          , m_pendingCount(0)
+          , m_done(false)
+          , m_failed(false)
+        {
+            std::thread thread(&ProjectWriter::run, this);
+            m_thread.swap(thread);
+        }
+
+        ~ProjectWriter()
+        {
+            finish();
+        }
+
+        // Queue an exported session for writing.
+        // Blocks while too many projects are waiting to be written.
+        void push(std::unique_ptr<SessionImpl> session)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_canPush.wait(lock, [this]() { return m_pendingCount < m_maxPendingProjects; });
+
+            ++m_pendingCount;
+            m_pending.push_back(std::move(session));
+            m_canWrite.notify_one();
+        }
+
+        // Destroy the sessions already written. Sessions are
+        // destroyed in the main thread, as they use the Maya API.
+        void releaseWrittenSessions()
+        {
+            std::vector<std::unique_ptr<SessionImpl>> written;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                written.swap(m_written);
+            }
+        }
+
+        // Wait until all the projects are written.
+        // Return false if any of them could not be written.
+        bool finish()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done = true;
+                m_canWrite.notify_one();
+            }
+
+            if (m_thread.joinable())
+                m_thread.join();
+
+            releaseWrittenSessions();
+            Tracer::flush();
+            return !m_failed;
+        }
+
+      private:
+        void run()
+        {
+            Tracer::setThreadName("Project writer");
+
+            while (true)
+            {
+                std::unique_ptr<SessionImpl> session;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_canWrite.wait(lock, [this]() { return m_done || !m_pending.empty(); });
+
+                    if (m_pending.empty())
+                        return;
+
+                    session = std::move(m_pending.front());
+                    m_pending.pop_front();
+                }
+
+                const bool success = session->writeProjectFile(session->m_fileName.asChar());
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+
+                    if (!success)
+                        m_failed = true;
+
+                    m_written.push_back(std::move(session));
+                    --m_pendingCount;
+                    m_canPush.notify_one();
+                }
+            }
+        }
+
+        const size_t                                m_maxPendingProjects;
+        size_t                                      m_pendingCount;
+        std::deque<std::unique_ptr<SessionImpl>>    m_pending;
+        std::vector<std::unique_ptr<SessionImpl>>   m_written;
+        bool                                        m_done;
+        bool                                        m_failed;
+        std::mutex                                  m_mutex;
+        std::condition_variable                     m_canPush;
+        std::condition_variable                     m_canWrite;
+        std::thread                                 m_thread;
     };
 }
 
@@ -1068,6 +2113,63 @@ namespace
     }
 }
 
+namespace
+{
+    // Export a sequence, writing the project of each frame
+    // in a background thread while exporting the next one.
+    MStatus pipelinedSequenceExport(
+        const std::string&                  fname_template,
+        const AppleseedSession::Options&    options,
+        ComputationPtr                      computation)
+    {
+        ProjectWriter writer(static_cast<size_t>(options.m_maxPendingFrames));
+
+        for (int frame = options.m_firstFrame; frame <= options.m_lastFrame; frame += options.m_frameStep)
+        {
+            writer.releaseWrittenSessions();
+
+            // Check if the user wants to abort the export.
+            if (computation->isInterruptRequested())
+            {
+                RENDERER_LOG_INFO("Project export aborted.");
+                writer.finish();
+                return MS::kSuccess;
+            }
+
+            MGlobal::viewFrame(frame);
+            const std::string fname = asf::get_numbered_string(fname_template, frame);
+            try
+            {
+                beginSession(fname.c_str(), options, computation);
+                g_globalSession->exportProject();
+                g_globalSession->writeBoundingBox(fname.c_str());
+
+                // The project is complete, write it in the background.
+                writer.push(std::move(g_globalSession));
+            }
+            catch (const AbortRequested&)
+            {
+                RENDERER_LOG_INFO("Project export aborted.");
+                writer.finish();
+                return MS::kSuccess;
+            }
+            catch (const AppleseedMayaException&)
+            {
+                writer.finish();
+                return MS::kFailure;
+            }
+        }
+
+        if (!writer.finish())
+        {
+            RENDERER_LOG_ERROR("Could not write some of the exported projects.");
+            return MS::kFailure;
+        }
+
+        return MS::kSuccess;
+    }
+}
+
 MStatus projectExport(const MString& fileName, const Options& options)
 {
     // In case we were doing IPR.
@@ -1088,6 +2190,24 @@ MStatus projectExport(const MString& fileName, const Options& options)
             return MS::kFailure;
         }
 
+        if (options.m_pipelinedExport)
+            return pipelinedSequenceExport(fname_template, options, computation);
+
+        // Reuse the session across frames when all the projects
+        // share the same directory (and the same geometry files).
+        bool persistent = true;
+        const bfs::path firstProjectPath =
+            bfs::path(asf::get_numbered_string(fname_template, options.m_firstFrame)).parent_path();
+
+        for (int frame = options.m_firstFrame; frame <= options.m_lastFrame; frame += options.m_frameStep)
+        {
+            if (bfs::path(asf::get_numbered_string(fname_template, frame)).parent_path() != firstProjectPath)
+            {
+                persistent = false;
+                break;
+            }
+        }
+
         for (int frame = options.m_firstFrame; frame <= options.m_lastFrame; frame += options.m_frameStep)
         {
             // Check if the user wants to abort the export.
@@ -1101,9 +2221,26 @@ MStatus projectExport(const MString& fileName, const Options& options)
             const std::string fname = asf::get_numbered_string(fname_template, frame);
             try
             {
-                beginSession(fname.c_str(), options, computation);
+                if (persistent && g_globalSession)
+                    g_globalSession->setFileName(fname.c_str());
+                else
+                {
+                    beginSession(fname.c_str(), options, computation);
+
+                    if (persistent)
+                        g_globalSession->setPersistent();
+                }
+
                 g_globalSession->exportProject();
                 g_globalSession->writeProject();
+
+                // Persistent sessions don't export shading again,
+                // export the next frames in their own sessions.
+                if (persistent && g_globalSession->hasAnimatedShading())
+                {
+                    RENDERER_LOG_INFO("Found animated shading nodes, exporting each frame in a new session.");
+                    persistent = false;
+                }
             }
             catch (const AbortRequested&)
             {
@@ -1174,6 +2311,52 @@ MStatus render(const Options& options)
     return MS::kSuccess;
 }
 
+MStatus progressiveRender(Options options)
+{
+    // In case we were rendering.
+    endSession();
+
+    // Only used to interrupt the initial export.
+    ComputationPtr computation = Computation::create();
+
+    g_savedTime = MAnimControl::currentTime();
+    g_savedLogLevel = asr::global_logger().get_verbosity_level();
+
+    try
+    {
+        beginSession(ProgressiveRenderSession, options, computation);
+        g_globalSession->exportProject();
+
+        if (computation->isInterruptRequested())
+        {
+            RENDERER_LOG_INFO("Interactive render aborted.");
+            endSession();
+            return MS::kSuccess;
+        }
+
+        g_globalSession->progressiveRender();
+    }
+    catch (const AbortRequested&)
+    {
+        RENDERER_LOG_INFO("Interactive render aborted.");
+        endSession();
+        return MS::kSuccess;
+    }
+    catch (const AppleseedMayaException&)
+    {
+        endSession();
+        return MS::kFailure;
+    }
+
+    return MS::kSuccess;
+}
+
+void pauseProgressiveRender(const bool pause)
+{
+    if (sessionMode() == ProgressiveRenderSession)
+        g_globalSession->pauseProgressiveRender(pause);
+}
+
 namespace
 {
     MString batchRenderFileName(
@@ -1409,6 +2592,12 @@ void endSession()
         asr::global_logger().set_verbosity_level(g_savedLogLevel);
 
         IdleJobQueue::stop();
+
+        PixelBufferPool::logStatistics();
+        PixelBufferPool::releaseUnusedBuffers();
+        PixelBufferPool::resetStatistics();
+
+        Tracer::flush();
     }
 }
 
@@ -1428,3 +2617,26 @@ const Options& options()
 }
 
 } // namespace AppleseedSession.
+
+namespace
+{
+    void applySceneEdits()
+    {
+        if (AppleseedSession::sessionMode() != AppleseedSession::ProgressiveRenderSession)
+            return;
+
+        try
+        {
+            if (!g_globalSession->applySceneEdits())
+            {
+                RENDERER_LOG_DEBUG("Render globals edited, exporting the scene again");
+                AppleseedSession::progressiveRender(g_globalSession->m_options);
+            }
+        }
+        catch (const AppleseedMayaException&)
+        {
+            RENDERER_LOG_ERROR("Could not apply scene edits, stopping interactive render.");
+            AppleseedSession::endSession();
+        }
+    }
+}
@@ -99,6 +99,8 @@ struct Options
     int         m_lastFrame;
     int         m_frameStep;
     bool        m_writeBoundingBox;
+    bool        m_pipelinedExport;      // write frame N while exporting frame N + 1
+    int         m_maxPendingFrames;     // max number of projects waiting to be written
 };
 
 struct MotionBlurSampleTimes
@@ -159,6 +161,13 @@ MStatus render(const Options& options);
 // Export and batch render the current scene.
 MStatus batchRender(Options options);
 
+// Export the current scene and start an interactive render to Maya's render view.
+// Scene edits are applied incrementally until the session ends.
+MStatus progressiveRender(Options options);
+
+// Pause or resume the interactive render.
+void pauseProgressiveRender(const bool pause);
+
 // Swatch rendering.
 bool exportMaterialSwatch(renderer::Project& project, const MObject& node);
 bool exportTextureSwatch(renderer::Project& project, const MObject& node);
@@ -95,6 +95,10 @@ void parseOptions(
                 options.m_lastFrame = atoi(optNameValue[1].c_str());
             else if (optNameValue[0] == "stepFrame")
                 options.m_frameStep = atoi(optNameValue[1].c_str());
+            else if (optNameValue[0] == "pipelinedExport")
+                options.m_pipelinedExport = (optNameValue[1] == "true");
+            else if (optNameValue[0] == "maxPendingFrames")
+                options.m_maxPendingFrames = atoi(optNameValue[1].c_str());
             else
             {
                 RENDERER_LOG_WARNING(
@@ -117,3 +117,8 @@ const char*AlphaMapExporter::textureInstanceName() const
 {
     return m_textureInstance->get_name();
 }
+
+MObject AlphaMapExporter::node() const
+{
+    return m_object;
+}
@@ -74,6 +74,9 @@ class AlphaMapExporter
 
     const char* textureInstanceName() const;
 
+    // Return the Maya alpha map node.
+    MObject node() const;
+
   private:
     AlphaMapExporter(
       const MObject&                object,
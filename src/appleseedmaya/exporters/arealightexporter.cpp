@@ -77,7 +77,7 @@ AreaLightExporter::AreaLightExporter(
 
 AreaLightExporter::~AreaLightExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         mainAssembly().materials().remove(m_material.get());
         mainAssembly().materials().remove(m_backMaterial.get());
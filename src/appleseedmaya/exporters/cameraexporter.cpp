@@ -80,7 +80,7 @@ CameraExporter::CameraExporter(
 
 CameraExporter::~CameraExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
         scene().cameras().remove(m_camera.get());
 }
 
@@ -214,6 +214,17 @@ void CameraExporter::flushEntities()
     scene().cameras().insert(m_camera.release());
 }
 
+bool CameraExporter::updateTransform()
+{
+    if (m_camera.get() == nullptr)
+        return false;
+
+    m_camera->transform_sequence().clear();
+    exportCameraMotionStep(0.0f);
+    m_camera->bump_version_id();
+    return true;
+}
+
 bool CameraExporter::isRenderable(const MDagPath& path)
 {
     bool isRenderable = false;
@@ -59,6 +59,8 @@ class CameraExporter
 
     void flushEntities() override;
 
+    bool updateTransform() override;
+
   private:
     CameraExporter(
       const MDagPath&                                   path,
@@ -58,6 +58,7 @@ DagNodeExporter::DagNodeExporter(
     AppleseedSession::SessionMode   sessionMode)
   : m_path(path)
   , m_sessionMode(sessionMode)
+  , m_removeEntitiesOnDestruction(sessionMode == AppleseedSession::ProgressiveRenderSession)
   , m_project(project)
   , m_scene(*project.get_scene())
   , m_mainAssembly(*m_scene.assemblies().get_by_name("assembly"))
@@ -78,6 +79,16 @@ AppleseedSession::SessionMode DagNodeExporter::sessionMode() const
     return m_sessionMode;
 }
 
+void DagNodeExporter::setRemoveEntitiesOnDestruction()
+{
+    m_removeEntitiesOnDestruction = true;
+}
+
+bool DagNodeExporter::removeEntitiesOnDestruction() const
+{
+    return m_removeEntitiesOnDestruction;
+}
+
 asr::Project& DagNodeExporter::project()
 {
     return m_project;
@@ -114,6 +125,20 @@ void DagNodeExporter::exportShapeMotionStep(float time)
 {
 }
 
+void DagNodeExporter::buildEntities()
+{
+}
+
+size_t DagNodeExporter::geometrySize() const
+{
+    return 0;
+}
+
+bool DagNodeExporter::updateTransform()
+{
+    return false;
+}
+
 asf::AABB3d DagNodeExporter::boundingBox() const
 {
     return asf::AABB3d();
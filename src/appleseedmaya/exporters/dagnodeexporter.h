@@ -98,12 +98,31 @@ class DagNodeExporter
     virtual void exportTransformMotionStep(float time);
     virtual void exportShapeMotionStep(float time);
 
+    // Finish building the entities once all motion steps have been exported.
+    // Called from worker threads: implementations must not call the Maya API.
+    virtual void buildEntities();
+
+    // Return the size in bytes of the geometry built by this exporter.
+    virtual size_t geometrySize() const;
+
     // Flush entities to the renderer.
     virtual void flushEntities() = 0;
 
+    // Update the transform of the flushed entities after the node was moved
+    // in an interactive session, without exporting the node again.
+    // Return false if the exporter does not support it.
+    virtual bool updateTransform();
+
     // Bounds.
     virtual foundation::AABB3d boundingBox() const;
 
+    // Remove the entities from the project when this exporter is destroyed,
+    // even outside of interactive sessions. Used to re-export nodes in place.
+    void setRemoveEntitiesOnDestruction();
+
+    // Return true if an object is animated.
+    static bool isAnimated(MObject object, bool checkParent = false);
+
   protected:
     // Constructor.
     DagNodeExporter(
@@ -114,6 +133,9 @@ class DagNodeExporter
     // Return the session mode.
     AppleseedSession::SessionMode sessionMode() const;
 
+    // Return true if the entities have to be removed from the project on destruction.
+    bool removeEntitiesOnDestruction() const;
+
     // Return a reference to the appleseed project.
     renderer::Project& project();
 
@@ -135,9 +157,6 @@ class DagNodeExporter
     // Return true if an object and all its parents are renderable.
     static bool areObjectAndParentsRenderable(const MDagPath& path);
 
-    // Return true if an object is animated.
-    static bool isAnimated(MObject object, bool checkParent = false);
-
     // Return the object space bounding box.
     static foundation::AABB3d objectSpaceBoundingBox(const MDagPath& path);
 
@@ -145,6 +164,7 @@ class DagNodeExporter
   private:
     MDagPath                      m_path;
     AppleseedSession::SessionMode m_sessionMode;
+    bool                          m_removeEntitiesOnDestruction;
     renderer::Project&            m_project;
     renderer::Scene&              m_scene;
     renderer::Assembly&           m_mainAssembly;
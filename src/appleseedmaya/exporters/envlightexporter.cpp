@@ -60,7 +60,7 @@ EnvLightExporter::EnvLightExporter(
 
 EnvLightExporter::~EnvLightExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         scene().environment_shaders().remove(m_envShader.get());
         scene().environment_edfs().remove(m_envLight.get());
@@ -122,7 +122,7 @@ PhysicalSkyLightExporter::PhysicalSkyLightExporter(
 
 PhysicalSkyLightExporter::~PhysicalSkyLightExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         if (m_sunLight.get())
             mainAssembly().lights().remove(m_sunLight.get());
@@ -230,7 +230,7 @@ SkyDomeLightExporter::SkyDomeLightExporter(
 
 SkyDomeLightExporter::~SkyDomeLightExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         if (m_mapTexture.get())
             scene().textures().remove(m_mapTexture.get());
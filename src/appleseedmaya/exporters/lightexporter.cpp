@@ -88,7 +88,7 @@ LightExporter::LightExporter(
 
 LightExporter::~LightExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         mainAssembly().colors().remove(m_lightColor.get());
         mainAssembly().lights().remove(m_light.get());
@@ -197,3 +197,16 @@ void LightExporter::flushEntities()
         mainAssembly().lights().insert(m_light.release());
     }
 }
+
+bool LightExporter::updateTransform()
+{
+    if (m_light.get() == nullptr)
+        return false;
+
+    asf::Matrix4d m = convert(dagPath().inclusiveMatrix());
+    asf::Matrix4d invM = convert(dagPath().inclusiveMatrixInverse());
+    asf::Transformd xform(m, invM);
+    m_light->set_transform(xform);
+    m_light->bump_version_id();
+    return true;
+}
@@ -63,6 +63,8 @@ class LightExporter
 
     void flushEntities() override;
 
+    bool updateTransform() override;
+
   private:
     LightExporter(
       const MDagPath&                                   path,
@@ -32,6 +32,7 @@
 // appleseed-maya headers.
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/paramencoder.h"
 #include "appleseedmaya/shadingnodemetadata.h"
 
 // Build options header.
@@ -47,7 +48,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <sstream>
 #include <vector>
 
 namespace asf = foundation;
@@ -151,25 +151,25 @@ void MandelbrotExporter::exportParameterValue(
 
         std::sort(mandelbrotColors.begin(), mandelbrotColors.end());
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssc;
-        ssc << "color[] ";
+        ParamEncoder values;
+        values.begin("color[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = mandelbrotColors.size(); i < e; ++i)
         {
-            ssp << mandelbrotColors[i].m_pos << " ";
-            ssc << mandelbrotColors[i].m_col.r << " " << mandelbrotColors[i].m_col.g << " " << mandelbrotColors[i].m_col.b << " ";
-            ssi << mandelbrotColors[i].m_interp << " ";
+            positions.append(mandelbrotColors[i].m_pos);
+            values.append(mandelbrotColors[i].m_col.r).append(mandelbrotColors[i].m_col.g).append(mandelbrotColors[i].m_col.b);
+            interps.append(mandelbrotColors[i].m_interp);
         }
 
-        shaderParams.insert("in_color_Position", ssp.str().c_str());
-        shaderParams.insert("in_color_Color"   , ssc.str().c_str());
-        shaderParams.insert("in_color_Interp"  , ssi.str().c_str());
+        positions.insert(shaderParams, "in_color_Position");
+        values.insert(shaderParams, "in_color_Color");
+        interps.insert(shaderParams, "in_color_Interp");
     }
     else if (paramInfo.paramName == "in_value_Position")
     {
@@ -199,25 +199,25 @@ void MandelbrotExporter::exportParameterValue(
 
         std::sort(mandelbrotValues.begin(), mandelbrotValues.end());
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = mandelbrotValues.size(); i < e; ++i)
         {
-            ssp << mandelbrotValues[i].m_pos << " ";
-            ssv << mandelbrotValues[i].m_val << " ";
-            ssi << mandelbrotValues[i].m_interp << " ";
+            positions.append(mandelbrotValues[i].m_pos);
+            values.append(mandelbrotValues[i].m_val);
+            interps.append(mandelbrotValues[i].m_interp);
         }
 
-        shaderParams.insert("in_value_Position", ssp.str().c_str());
-        shaderParams.insert("in_value_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_value_Interp"  , ssi.str().c_str());
+        positions.insert(shaderParams, "in_value_Position");
+        values.insert(shaderParams, "in_value_FloatValue");
+        interps.insert(shaderParams, "in_value_Interp");
     }
     else if (paramInfo.paramName == "in_color_Color" ||
              paramInfo.paramName == "in_color_Interp"||
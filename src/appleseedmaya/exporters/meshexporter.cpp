@@ -43,14 +43,13 @@
 
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MFloatArray.h>
 #include <maya/MFloatPointArray.h>
 #include <maya/MFnEnumAttribute.h>
 #include <maya/MFnMesh.h>
 #include <maya/MFnMeshData.h>
 #include <maya/MItDependencyGraph.h>
-#include <maya/MItMeshPolygon.h>
 #include <maya/MMeshSmoothOptions.h>
-#include <maya/MPointArray.h>
 #include <maya/MString.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
@@ -60,7 +59,11 @@
 #include "boost/filesystem/path.hpp"
 
 // Standard headers
+#include <algorithm>
 #include <array>
+#include <mutex>
+#include <set>
+#include <string>
 
 namespace bfs = boost::filesystem;
 namespace asf = foundation;
@@ -68,31 +71,125 @@ namespace asr = renderer;
 
 namespace
 {
+    // Gather mesh elements in small batches and hash each batch in one go.
+    template <typename T, typename Getter>
+    void appendElements(MurmurHash& hash, const size_t count, Getter getter)
+    {
+        hash.append(count);
+
+        std::array<T, 256> buffer;
+        for (size_t i = 0; i < count;)
+        {
+            const size_t n = std::min(count - i, buffer.size());
+            for (size_t j = 0; j < n; ++j)
+                buffer[j] = getter(i + j);
+
+            hash.appendSpan(buffer.data(), n);
+            i += n;
+        }
+    }
+
     void staticMeshObjectHash(const asr::MeshObject& mesh, MurmurHash& hash)
     {
-        hash.append(mesh.get_tex_coords_count());
-        for (size_t i = 0, e = mesh.get_tex_coords_count(); i < e; ++i)
-            hash.append(mesh.get_tex_coords(i));
+        appendElements<asr::GVector2>(
+            hash,
+            mesh.get_tex_coords_count(),
+            [&mesh](const size_t i) { return mesh.get_tex_coords(i); });
 
-        hash.append(mesh.get_triangle_count());
-        for (size_t i = 0, e = mesh.get_triangle_count(); i < e; ++i)
-            hash.append(mesh.get_triangle(i));
+        appendElements<asr::Triangle>(
+            hash,
+            mesh.get_triangle_count(),
+            [&mesh](const size_t i) { return mesh.get_triangle(i); });
 
         hash.append(mesh.get_material_slot_count());
         for (size_t i = 0, e = mesh.get_material_slot_count(); i < e; ++i)
             hash.append(mesh.get_material_slot(i));
 
-        hash.append(mesh.get_vertex_count());
-        for (size_t i = 0, e = mesh.get_vertex_count(); i < e; ++i)
-            hash.append(mesh.get_vertex(i));
+        appendElements<asr::GVector3>(
+            hash,
+            mesh.get_vertex_count(),
+            [&mesh](const size_t i) { return mesh.get_vertex(i); });
 
-        hash.append(mesh.get_vertex_normal_count());
-        for (size_t i = 0, e = mesh.get_vertex_normal_count(); i < e; ++i)
-            hash.append(mesh.get_vertex_normal(i));
+        appendElements<asr::GVector3>(
+            hash,
+            mesh.get_vertex_normal_count(),
+            [&mesh](const size_t i) { return mesh.get_vertex_normal(i); });
 
-        hash.append(mesh.get_vertex_tangent_count());
-        for (size_t i = 0, e = mesh.get_vertex_tangent_count(); i < e; ++i)
-            hash.append(mesh.get_vertex_tangent(i));
+        appendElements<asr::GVector3>(
+            hash,
+            mesh.get_vertex_tangent_count(),
+            [&mesh](const size_t i) { return mesh.get_vertex_tangent(i); });
+    }
+
+    // Approximate size of the mesh data in memory.
+    size_t meshObjectSize(const asr::MeshObject& mesh)
+    {
+        const size_t numKeys = mesh.get_motion_segment_count() + 1;
+
+        size_t size = 0;
+        size += mesh.get_vertex_count() * sizeof(asr::GVector3) * numKeys;
+        size += mesh.get_vertex_normal_count() * sizeof(asr::GVector3) * numKeys;
+        size += mesh.get_vertex_tangent_count() * sizeof(asr::GVector3) * numKeys;
+        size += mesh.get_tex_coords_count() * sizeof(asr::GVector2);
+        size += mesh.get_triangle_count() * sizeof(asr::Triangle);
+        return size;
+    }
+
+    void meshObjectPoseHash(const asr::MeshObject& mesh, const size_t pose, MurmurHash& hash)
+    {
+        appendElements<asr::GVector3>(
+            hash,
+            mesh.get_vertex_count(),
+            [&mesh, pose](const size_t i) { return mesh.get_vertex_pose(i, pose); });
+
+        appendElements<asr::GVector3>(
+            hash,
+            mesh.get_vertex_normal_count(),
+            [&mesh, pose](const size_t i) { return mesh.get_vertex_normal_pose(i, pose); });
+
+        appendElements<asr::GVector3>(
+            hash,
+            mesh.get_vertex_tangent_count(),
+            [&mesh, pose](const size_t i) { return mesh.get_vertex_tangent_pose(i, pose); });
+    }
+
+    template <typename MayaArray, typename T>
+    void copyArray(const MayaArray& src, std::vector<T>& dst)
+    {
+        dst.resize(src.length());
+        if (!dst.empty())
+            src.get(dst.data());
+    }
+
+    // Mesh files are written from several threads at once.
+    // Identical meshes map to the same file, only write it once.
+    std::mutex g_meshFilesMutex;
+    std::set<std::string> g_meshFilesInFlight;
+
+    void endMeshFileWrite(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(g_meshFilesMutex);
+        g_meshFilesInFlight.erase(path);
+    }
+
+    // Return true if the caller has to write the mesh file.
+    bool beginMeshFileWrite(const std::string& path)
+    {
+        {
+            std::lock_guard<std::mutex> lock(g_meshFilesMutex);
+
+            if (!g_meshFilesInFlight.insert(path).second)
+                return false;
+        }
+
+        // The path is claimed, check the file system without holding the lock.
+        if (bfs::exists(path))
+        {
+            endMeshFileWrite(path);
+            return false;
+        }
+
+        return true;
     }
 }
 
@@ -117,12 +214,13 @@ MeshExporter::MeshExporter(
     asr::Project&                                   project,
     AppleseedSession::SessionMode                   sessionMode)
   : ShapeExporter(path, project, sessionMode)
+  , m_geometrySize(0)
 {
 }
 
 MeshExporter::~MeshExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         if (m_objectAssembly.get() == nullptr)
             mainAssembly().objects().remove(m_mesh.get());
@@ -261,108 +359,70 @@ void MeshExporter::exportShapeMotionStep(float time)
     MStatus status;
     MeshAndData finalMesh = getFinalMesh(&status);
 
-    if (sessionMode() == AppleseedSession::ExportSession)
+    // Only copy the Maya data here, the appleseed mesh
+    // is built later in parallel by buildEntities().
+    if (m_shapeExportStep == 1)
     {
-        MString objectName = appleseedName();
-        m_mesh.reset(asr::MeshObjectFactory().create(objectName.asChar(), m_meshParams));
-
-        createMaterialSlots();
-        fillTopology(finalMesh.m_mesh);
-        exportGeometry(finalMesh.m_mesh);
+        snapshotTopology(finalMesh.m_mesh);
 
-        // Compute smooth tangents if needed.
-        if (m_smoothTangents)
-        {
-            assert(m_exportUVs);
-            asr::compute_smooth_vertex_tangents(*m_mesh);
-        }
+        // The name comes from the dag path, it can't be read by the worker threads.
+        m_topology.m_objectName = appleseedName().asChar();
+    }
 
-        MurmurHash meshHash;
-        staticMeshObjectHash(*m_mesh, meshHash);
+    snapshotKey(finalMesh.m_mesh);
 
-        const char* extension = ".binarymesh";
-        const std::string fileName = std::string("_geometry/") + meshHash.toString() + extension;
+    m_shapeExportStep++;
+}
 
-        bfs::path projectPath = project().search_paths().get_root_path().c_str();
-        bfs::path p = projectPath / fileName;
+void MeshExporter::buildEntities()
+{
+    if (m_keys.empty())
+        return;
 
-        // Write a geom file for the object if needed.
-        if (!bfs::exists(p))
+    if (sessionMode() == AppleseedSession::ExportSession)
+    {
+        for (size_t i = 0, e = m_keys.size(); i < e; ++i)
         {
-            if (!asr::MeshObjectWriter::write(*m_mesh, "mesh", p.string().c_str()))
+            const MurmurHash meshHash = writeMeshFile(m_keys[i]);
+            m_geometrySize += meshObjectSize(*m_mesh);
+
+            // Update the mesh hash.
+            if (i == 0)
             {
-                RENDERER_LOG_ERROR(
-                    "Couldn't export mesh file for object %s.",
-                    m_mesh->get_name());
+                m_hash = meshHash;
+                m_hash.append(m_mesh->get_parameters());
+                m_hash.append(m_frontMaterialMappings);
+                m_hash.append(m_backMaterialMappings);
             }
-        }
-        else
-        {
-            RENDERER_LOG_INFO(
-                "Mesh file for object %s already exists.",
-                m_mesh->get_name());
-        }
-
-        m_fileNames.push_back(fileName);
-
-        // Update the mesh hash.
-        if (m_shapeExportStep == 1)
-        {
-            m_hash = meshHash;
-            m_hash.append(m_mesh->get_parameters());
-            m_hash.append(m_frontMaterialMappings);
-            m_hash.append(m_backMaterialMappings);
-        }
-        else
-        {
-            m_hash.append(m_mesh->get_vertex_count());
-            for (size_t i = 0, e = m_mesh->get_vertex_count(); i < e; ++i)
-                m_hash.append(m_mesh->get_vertex(i));
-
-            m_hash.append(m_mesh->get_vertex_normal_count());
-            for (size_t i = 0, e = m_mesh->get_vertex_normal_count(); i < e; ++i)
-                m_hash.append(m_mesh->get_vertex_normal(i));
-
-            m_hash.append(m_mesh->get_vertex_tangent_count());
-            for (size_t i = 0, e = m_mesh->get_vertex_tangent_count(); i < e; ++i)
-                m_hash.append(m_mesh->get_vertex_tangent(i));
+            else
+                m_hash.append(meshHash);
         }
     }
     else
     {
-        if (m_shapeExportStep == 1)
-        {
-            fillTopology(finalMesh.m_mesh);
-            exportGeometry(finalMesh.m_mesh);
+        fillTopology();
+        exportGeometry(m_keys[0]);
 
-            // Update the mesh hash.
-            staticMeshObjectHash(*m_mesh, m_hash);
-            m_hash.append(m_mesh->get_parameters());
-            m_hash.append(m_frontMaterialMappings);
-            m_hash.append(m_backMaterialMappings);
-        }
-        else
+        // Update the mesh hash.
+        staticMeshObjectHash(*m_mesh, m_hash);
+        m_hash.append(m_mesh->get_parameters());
+        m_hash.append(m_frontMaterialMappings);
+        m_hash.append(m_backMaterialMappings);
+
+        for (size_t i = 1, e = m_keys.size(); i < e; ++i)
         {
-            exportMeshKey(finalMesh.m_mesh);
+            exportMeshKey(m_keys[i], i);
 
             // Update the mesh hash.
-            const size_t pose = m_shapeExportStep - 1;
-
-            m_hash.append(m_mesh->get_vertex_count());
-            for (size_t i = 0, e = m_mesh->get_vertex_count(); i < e; ++i)
-                m_hash.append(m_mesh->get_vertex_pose(i, pose));
-
-            m_hash.append(m_mesh->get_vertex_normal_count());
-            for (size_t i = 0, e = m_mesh->get_vertex_normal_count(); i < e; ++i)
-                m_hash.append(m_mesh->get_vertex_normal_pose(i, pose));
-
-            m_hash.append(m_mesh->get_vertex_tangent_count());
-            for (size_t i = 0, e = m_mesh->get_vertex_tangent_count(); i < e; ++i)
-                m_hash.append(m_mesh->get_vertex_tangent_pose(i, pose));
+            meshObjectPoseHash(*m_mesh, i - 1, m_hash);
         }
+
+        m_geometrySize = meshObjectSize(*m_mesh);
     }
 
-    m_shapeExportStep++;
+    // Release the Maya data copies.
+    m_topology = TopologySnapshot();
+    m_keys.clear();
 }
 
 void MeshExporter::flushEntities()
@@ -435,6 +495,11 @@ MurmurHash MeshExporter::hash() const
     return m_hash;
 }
 
+size_t MeshExporter::geometrySize() const
+{
+    return m_geometrySize;
+}
+
 void MeshExporter::meshAttributesToParams(renderer::ParamArray& params)
 {
     int mediumPriority = 0;
@@ -523,127 +588,152 @@ void MeshExporter::createMaterialSlots()
         m_mesh->push_material_slot("default");
 }
 
-void MeshExporter::fillTopology(MObject mesh)
+void MeshExporter::snapshotTopology(MObject mesh)
 {
     MStatus status;
+    MFnMesh meshFn(mesh);
 
-    // Triangle buffer.
-    std::vector<asr::Triangle> triangles;
-
+    // Read the whole topology in a few calls.
+    MIntArray faceVertexCounts;
     MIntArray faceVertexIndices;
-    MIntArray faceUVIndices;
-    MIntArray faceNormalIndices;
-    MIntArray triangleVertexIndices;
-    MPointArray trianglePoints;
+    status = meshFn.getVertices(faceVertexCounts, faceVertexIndices);
+    copyArray(faceVertexCounts, m_topology.m_faceVertexCounts);
+    copyArray(faceVertexIndices, m_topology.m_faceVertexIndices);
+
+    // Triangle corners, as offsets in the face vertex array.
+    MIntArray triangleCounts;
+    MIntArray triangleOffsets;
+    status = meshFn.getTriangleOffsets(triangleCounts, triangleOffsets);
+    copyArray(triangleCounts, m_topology.m_triangleCounts);
+    copyArray(triangleOffsets, m_topology.m_triangleOffsets);
 
-    MItMeshPolygon faceIt(mesh);
-    for (;!faceIt.isDone(); faceIt.next())
+    if (m_exportUVs)
     {
-        // Get the material index for this face.
-        int materialIndex = 0;
-        if (m_perFaceAssignments.length() != 0)
-            materialIndex = m_perFaceAssignments[faceIt.index()];
+        MIntArray faceUVCounts;
+        MIntArray faceUVIndices;
+        status = meshFn.getAssignedUVs(faceUVCounts, faceUVIndices);
+        copyArray(faceUVCounts, m_topology.m_faceUVCounts);
+        copyArray(faceUVIndices, m_topology.m_faceUVIndices);
 
-        // Collect normal and uv indices for this face.
-        faceUVIndices.clear();
-        faceNormalIndices.clear();
+        MFloatArray u, v;
+        status = meshFn.getUVs(u, v);
+        copyArray(u, m_topology.m_u);
+        copyArray(v, m_topology.m_v);
+    }
 
-        faceIt.getVertices(faceVertexIndices);
-        for (unsigned int i = 0, e = faceVertexIndices.length(); i < e; ++i)
-        {
-            if (m_exportUVs)
-            {
-                int uvIndex;
-                status = faceIt.getUVIndex(static_cast<int>(i), uvIndex);
-                faceUVIndices.append(uvIndex);
-            }
+    if (m_exportNormals)
+    {
+        MIntArray faceNormalCounts;
+        MIntArray faceNormalIndices;
+        status = meshFn.getNormalIds(faceNormalCounts, faceNormalIndices);
+        copyArray(faceNormalIndices, m_topology.m_faceNormalIndices);
+    }
+}
 
-            if (m_exportNormals)
-            {
-                unsigned int normalIndex = faceIt.normalIndex(static_cast<int>(i), &status);
-                faceNormalIndices.append(normalIndex);
-            }
-        }
+void MeshExporter::snapshotKey(MObject mesh)
+{
+    MStatus status;
+    MFnMesh meshFn(mesh);
 
-        // Match the triangle indices to the face indices.
-        int numTris;
-        faceIt.numTriangles(numTris);
-        for (int i = 0; i < numTris; ++i)
-        {
-            trianglePoints.clear();
-            triangleVertexIndices.clear();
-            faceIt.getTriangle(i, trianglePoints, triangleVertexIndices);
+    m_keys.push_back(KeySnapshot());
+    KeySnapshot& key = m_keys.back();
 
-            int triangleVertexOffset[3] = {-1, -1, -1};
-            for (unsigned int j = 0, je = faceVertexIndices.length(); j < je; ++j)
-            {
-                if (faceVertexIndices[j] == triangleVertexIndices[0])
-                    triangleVertexOffset[0] = j;
-                else if (faceVertexIndices[j] == triangleVertexIndices[1])
-                    triangleVertexOffset[1] = j;
-                else if (faceVertexIndices[j] == triangleVertexIndices[2])
-                    triangleVertexOffset[2] = j;
-            }
+    {
+        const float* p = meshFn.getRawPoints(&status);
+        key.m_points.assign(p, p + 3 * meshFn.numVertices());
+    }
+
+    if (m_exportNormals)
+    {
+        const float* p = meshFn.getRawNormals(&status);
+        key.m_normals.assign(p, p + 3 * meshFn.numNormals());
+    }
+}
+
+void MeshExporter::fillTopology()
+{
+    const TopologySnapshot& topo = m_topology;
+
+    m_mesh->reserve_triangles(topo.m_triangleOffsets.size() / 3);
+
+    size_t faceVertexBase = 0;
+    size_t faceUVBase = 0;
+    size_t triangleCorner = 0;
+
+    for (size_t face = 0, numFaces = topo.m_faceVertexCounts.size(); face < numFaces; ++face)
+    {
+        // Get the material index for this face.
+        const int materialIndex =
+            m_perFaceAssignments.length() != 0 ? m_perFaceAssignments[static_cast<unsigned int>(face)] : 0;
+
+        // Faces without UVs get the first UV.
+        const bool faceHasUVs = m_exportUVs && topo.m_faceUVCounts[face] != 0;
+
+        for (int i = 0, e = topo.m_triangleCounts[face]; i < e; ++i, triangleCorner += 3)
+        {
+            const size_t o0 = topo.m_triangleOffsets[triangleCorner + 0];
+            const size_t o1 = topo.m_triangleOffsets[triangleCorner + 1];
+            const size_t o2 = topo.m_triangleOffsets[triangleCorner + 2];
 
             asr::Triangle triangle(
-                faceVertexIndices[triangleVertexOffset[0]],
-                faceVertexIndices[triangleVertexOffset[1]],
-                faceVertexIndices[triangleVertexOffset[2]],
+                topo.m_faceVertexIndices[o0],
+                topo.m_faceVertexIndices[o1],
+                topo.m_faceVertexIndices[o2],
                 materialIndex);
 
             if (m_exportUVs)
             {
-                triangle.m_a0 = faceUVIndices[triangleVertexOffset[0]];
-                triangle.m_a1 = faceUVIndices[triangleVertexOffset[1]];
-                triangle.m_a2 = faceUVIndices[triangleVertexOffset[2]];
+                if (faceHasUVs)
+                {
+                    triangle.m_a0 = topo.m_faceUVIndices[faceUVBase + o0 - faceVertexBase];
+                    triangle.m_a1 = topo.m_faceUVIndices[faceUVBase + o1 - faceVertexBase];
+                    triangle.m_a2 = topo.m_faceUVIndices[faceUVBase + o2 - faceVertexBase];
+                }
+                else
+                    triangle.m_a0 = triangle.m_a1 = triangle.m_a2 = 0;
             }
 
             if (m_exportNormals)
             {
-                triangle.m_n0 = faceNormalIndices[triangleVertexOffset[0]];
-                triangle.m_n1 = faceNormalIndices[triangleVertexOffset[1]];
-                triangle.m_n2 = faceNormalIndices[triangleVertexOffset[2]];
+                triangle.m_n0 = topo.m_faceNormalIndices[o0];
+                triangle.m_n1 = topo.m_faceNormalIndices[o1];
+                triangle.m_n2 = topo.m_faceNormalIndices[o2];
             }
 
-            triangles.push_back(triangle);
+            m_mesh->push_triangle(triangle);
         }
-    }
 
-    // Copy triangles to the mesh.
-    m_mesh->reserve_triangles(triangles.size());
-    for (size_t i = 0, e = triangles.size(); i < e; ++i)
-        m_mesh->push_triangle(triangles[i]);
+        faceVertexBase += topo.m_faceVertexCounts[face];
+
+        if (m_exportUVs)
+            faceUVBase += topo.m_faceUVCounts[face];
+    }
 }
 
-void MeshExporter::exportGeometry(MObject mesh)
+void MeshExporter::exportGeometry(const KeySnapshot& key)
 {
-    MStatus status;
-    MFnMesh meshFn(mesh);
-
     // Vertices.
-    m_mesh->reserve_vertices(meshFn.numVertices());
+    m_mesh->reserve_vertices(key.m_points.size() / 3);
     {
-        const float* p = meshFn.getRawPoints(&status);
-        for (size_t i = 0, e = meshFn.numVertices(); i < e; ++i, p += 3)
+        const float* p = key.m_points.data();
+        for (size_t i = 0, e = key.m_points.size() / 3; i < e; ++i, p += 3)
             m_mesh->push_vertex(asr::GVector3(p[0], p[1], p[2]));
     }
 
     if (m_exportUVs)
     {
-        m_mesh->reserve_tex_coords(meshFn.numUVs());
-        MFloatArray u, v;
-        status = meshFn.getUVs(u, v);
-        for (int i = 0, e = meshFn.numUVs(); i < e; ++i)
-            m_mesh->push_tex_coords(asr::GVector2(u[i], v[i]));
+        m_mesh->reserve_tex_coords(m_topology.m_u.size());
+        for (size_t i = 0, e = m_topology.m_u.size(); i < e; ++i)
+            m_mesh->push_tex_coords(asr::GVector2(m_topology.m_u[i], m_topology.m_v[i]));
     }
 
     if (m_exportNormals)
     {
         const asr::GVector3 Y(0.0f, 1.0f, 0.0f);
-        m_mesh->reserve_vertex_normals(meshFn.numNormals());
-        const float* p = meshFn.getRawNormals(&status);
+        m_mesh->reserve_vertex_normals(key.m_normals.size() / 3);
+        const float* p = key.m_normals.data();
 
-        for (int i = 0, e = meshFn.numNormals(); i < e; ++i, p += 3)
+        for (size_t i = 0, e = key.m_normals.size() / 3; i < e; ++i, p += 3)
         {
             asr::GVector3 n(p[0], p[1], p[2]);
             m_mesh->push_vertex_normal(asf::safe_normalize(n, Y));
@@ -651,12 +741,9 @@ void MeshExporter::exportGeometry(MObject mesh)
     }
 }
 
-void MeshExporter::exportMeshKey(MObject mesh)
+void MeshExporter::exportMeshKey(const KeySnapshot& key, const size_t keyIndex)
 {
-    MStatus status;
-    MFnMesh meshFn(mesh);
-
-    if (m_shapeExportStep == 1)
+    if (keyIndex == 1)
     {
         assert(m_isDeforming);
         assert(m_numMeshKeys > 1);
@@ -667,12 +754,12 @@ void MeshExporter::exportMeshKey(MObject mesh)
 
     // Vertices.
     {
-        const float* p = meshFn.getRawPoints(&status);
-        for (size_t i = 0, e = meshFn.numVertices(); i < e; ++i, p += 3)
+        const float* p = key.m_points.data();
+        for (size_t i = 0, e = key.m_points.size() / 3; i < e; ++i, p += 3)
         {
             m_mesh->set_vertex_pose(
                 i,
-                m_shapeExportStep - 1,
+                keyIndex - 1,
                 asr::GVector3(p[0], p[1], p[2]));
         }
     }
@@ -680,16 +767,62 @@ void MeshExporter::exportMeshKey(MObject mesh)
     if (m_exportNormals)
     {
         const asr::GVector3 Y(0.0f, 1.0f, 0.0f);
-        m_mesh->reserve_vertex_normals(meshFn.numNormals());
-        const float* p = meshFn.getRawNormals(&status);
+        const float* p = key.m_normals.data();
 
-        for (size_t i = 0, e = meshFn.numNormals(); i < e; ++i, p += 3)
+        for (size_t i = 0, e = key.m_normals.size() / 3; i < e; ++i, p += 3)
         {
             asr::GVector3 n(p[0], p[1], p[2]);
             m_mesh->set_vertex_normal_pose(
                 i,
-                m_shapeExportStep - 1,
+                keyIndex - 1,
                 asf::safe_normalize(n, Y));
         }
     }
 }
+
+MurmurHash MeshExporter::writeMeshFile(const KeySnapshot& key)
+{
+    m_mesh.reset(asr::MeshObjectFactory().create(m_topology.m_objectName.c_str(), m_meshParams));
+
+    createMaterialSlots();
+    fillTopology();
+    exportGeometry(key);
+
+    // Compute smooth tangents if needed.
+    if (m_smoothTangents)
+    {
+        assert(m_exportUVs);
+        asr::compute_smooth_vertex_tangents(*m_mesh);
+    }
+
+    MurmurHash meshHash;
+    staticMeshObjectHash(*m_mesh, meshHash);
+
+    const char* extension = ".binarymesh";
+    const std::string fileName = std::string("_geometry/") + meshHash.toString() + extension;
+
+    bfs::path projectPath = project().search_paths().get_root_path().c_str();
+    bfs::path p = projectPath / fileName;
+
+    // Write a geom file for the object if needed.
+    if (beginMeshFileWrite(p.string()))
+    {
+        if (!asr::MeshObjectWriter::write(*m_mesh, "mesh", p.string().c_str()))
+        {
+            RENDERER_LOG_ERROR(
+                "Couldn't export mesh file for object %s.",
+                m_mesh->get_name());
+        }
+
+        endMeshFileWrite(p.string());
+    }
+    else
+    {
+        RENDERER_LOG_DEBUG(
+            "Mesh file for object %s already exists.",
+            m_mesh->get_name());
+    }
+
+    m_fileNames.push_back(fileName);
+    return meshHash;
+}
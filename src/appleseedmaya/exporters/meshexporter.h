@@ -75,6 +75,10 @@ class MeshExporter
 
     void exportShapeMotionStep(float time) override;
 
+    void buildEntities() override;
+
+    size_t geometrySize() const override;
+
     void flushEntities() override;
 
     bool supportsInstancing() const override;
@@ -98,10 +102,35 @@ class MeshExporter
     int getSmoothLevel(MStatus* ReturnStatus = nullptr) const;
     MeshAndData getFinalMesh(MStatus* ReturnStatus = nullptr) const;
 
+    // Raw Maya mesh data, captured in the main thread.
+    struct TopologySnapshot
+    {
+        std::string         m_objectName;
+        std::vector<int>    m_faceVertexCounts;
+        std::vector<int>    m_faceVertexIndices;
+        std::vector<int>    m_triangleCounts;
+        std::vector<int>    m_triangleOffsets;
+        std::vector<int>    m_faceUVCounts;
+        std::vector<int>    m_faceUVIndices;
+        std::vector<int>    m_faceNormalIndices;
+        std::vector<float>  m_u;
+        std::vector<float>  m_v;
+    };
+
+    struct KeySnapshot
+    {
+        std::vector<float>  m_points;
+        std::vector<float>  m_normals;
+    };
+
+    void snapshotTopology(MObject mesh);
+    void snapshotKey(MObject mesh);
+
     void createMaterialSlots();
-    void fillTopology(MObject mesh);
-    void exportGeometry(MObject mesh);
-    void exportMeshKey(MObject mesh);
+    void fillTopology();
+    void exportGeometry(const KeySnapshot& key);
+    void exportMeshKey(const KeySnapshot& key, const size_t keyIndex);
+    MurmurHash writeMeshFile(const KeySnapshot& key);
 
     AppleseedEntityPtr<renderer::MeshObject>    m_mesh;
     renderer::ParamArray                        m_meshParams;
@@ -114,6 +143,9 @@ class MeshExporter
     size_t                                      m_numMeshKeys;
     size_t                                      m_shapeExportStep;
     AlphaMapExporterPtr                         m_alphaMapExporter;
+    TopologySnapshot                            m_topology;
+    std::vector<KeySnapshot>                    m_keys;
+    size_t                                      m_geometrySize;
     MurmurHash                                  m_hash;
 };
 
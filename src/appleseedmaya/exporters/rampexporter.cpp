@@ -48,7 +48,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <sstream>
 #include <vector>
 
 namespace asf = foundation;
@@ -128,12 +127,12 @@ void RampExporter::exportParameterValue(
             std::sort(rampColors.begin(), rampColors.end());
         }
 
-        std::string values;
-        std::string positions;
+        ParamEncoder values;
+        ParamEncoder positions;
         serializeRamp(rampColors, values, positions);
 
-        shaderParams.insert("in_position", positions.c_str());
-        shaderParams.insert("in_color"   , values.c_str());
+        positions.insert(shaderParams, "in_position");
+        values.insert(shaderParams, "in_color");
     }
     else if (paramInfo.paramName == "in_color")
     {
@@ -32,6 +32,7 @@
 // appleseed-maya headers.
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/paramencoder.h"
 #include "appleseedmaya/shadingnodemetadata.h"
 
 // Build options header.
@@ -47,7 +48,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <sstream>
 #include <vector>
 
 namespace asf = foundation;
@@ -130,25 +130,25 @@ void RemapColorExporter::exportParameterValue(
             remapRed.push_back(RemapColorEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapRed.size(); i < e; ++i)
         {
-            ssp << remapRed[i].m_pos    << " ";
-            ssv << remapRed[i].m_value  << " ";
-            ssi << remapRed[i].m_interp << " ";
+            positions.append(remapRed[i].m_pos);
+            values.append(remapRed[i].m_value);
+            interps.append(remapRed[i].m_interp);
         }
 
-        shaderParams.insert("in_red_Position"  , ssp.str().c_str());
-        shaderParams.insert("in_red_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_red_Interp"    , ssi.str().c_str());
+        positions.insert(shaderParams, "in_red_Position");
+        values.insert(shaderParams, "in_red_FloatValue");
+        interps.insert(shaderParams, "in_red_Interp");
     }
     else if (paramInfo.paramName == "in_green_Position")
     {
@@ -176,25 +176,25 @@ void RemapColorExporter::exportParameterValue(
             remapGreen.push_back(RemapColorEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapGreen.size(); i < e; ++i)
         {
-            ssp << remapGreen[i].m_pos    << " ";
-            ssv << remapGreen[i].m_value  << " ";
-            ssi << remapGreen[i].m_interp << " ";
+            positions.append(remapGreen[i].m_pos);
+            values.append(remapGreen[i].m_value);
+            interps.append(remapGreen[i].m_interp);
         }
 
-        shaderParams.insert("in_green_Position"  , ssp.str().c_str());
-        shaderParams.insert("in_green_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_green_Interp"    , ssi.str().c_str());
+        positions.insert(shaderParams, "in_green_Position");
+        values.insert(shaderParams, "in_green_FloatValue");
+        interps.insert(shaderParams, "in_green_Interp");
     }
     else if (paramInfo.paramName == "in_blue_Position")
     {
@@ -222,25 +222,25 @@ void RemapColorExporter::exportParameterValue(
             remapBlue.push_back(RemapColorEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapBlue.size(); i < e; ++i)
         {
-            ssp << remapBlue[i].m_pos    << " ";
-            ssv << remapBlue[i].m_value  << " ";
-            ssi << remapBlue[i].m_interp << " ";
+            positions.append(remapBlue[i].m_pos);
+            values.append(remapBlue[i].m_value);
+            interps.append(remapBlue[i].m_interp);
         }
 
-        shaderParams.insert("in_blue_Position"  , ssp.str().c_str());
-        shaderParams.insert("in_blue_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_blue_Interp"    , ssi.str().c_str());
+        positions.insert(shaderParams, "in_blue_Position");
+        values.insert(shaderParams, "in_blue_FloatValue");
+        interps.insert(shaderParams, "in_blue_Interp");
     }
     else if (
         paramInfo.paramName == "in_red_FloatValue" ||
@@ -32,6 +32,7 @@
 // appleseed-maya headers.
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/paramencoder.h"
 #include "appleseedmaya/shadingnodemetadata.h"
 
 // Build options header.
@@ -47,7 +48,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <sstream>
 #include <vector>
 
 namespace asf = foundation;
@@ -130,25 +130,25 @@ void RemapHsvExporter::exportParameterValue(
             remapHue.push_back(RemapHsvEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapHue.size(); i < e; ++i)
         {
-            ssp << remapHue[i].m_pos    << " ";
-            ssv << remapHue[i].m_value  << " ";
-            ssi << remapHue[i].m_interp << " ";
+            positions.append(remapHue[i].m_pos);
+            values.append(remapHue[i].m_value);
+            interps.append(remapHue[i].m_interp);
         }
 
-        shaderParams.insert("in_hue_Position"  , ssp.str().c_str());
-        shaderParams.insert("in_hue_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_hue_Interp"    , ssi.str().c_str());
+        positions.insert(shaderParams, "in_hue_Position");
+        values.insert(shaderParams, "in_hue_FloatValue");
+        interps.insert(shaderParams, "in_hue_Interp");
     }
     else if (paramInfo.paramName == "in_saturation_Position")
     {
@@ -176,25 +176,25 @@ void RemapHsvExporter::exportParameterValue(
             remapSaturation.push_back(RemapHsvEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapSaturation.size(); i < e; ++i)
         {
-            ssp << remapSaturation[i].m_pos    << " ";
-            ssv << remapSaturation[i].m_value  << " ";
-            ssi << remapSaturation[i].m_interp << " ";
+            positions.append(remapSaturation[i].m_pos);
+            values.append(remapSaturation[i].m_value);
+            interps.append(remapSaturation[i].m_interp);
         }
 
-        shaderParams.insert("in_saturation_Position"  , ssp.str().c_str());
-        shaderParams.insert("in_saturation_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_saturation_Interp"    , ssi.str().c_str());
+        positions.insert(shaderParams, "in_saturation_Position");
+        values.insert(shaderParams, "in_saturation_FloatValue");
+        interps.insert(shaderParams, "in_saturation_Interp");
     }
     else if (paramInfo.paramName == "in_value_Position")
     {
@@ -222,25 +222,25 @@ void RemapHsvExporter::exportParameterValue(
             remapValue.push_back(RemapHsvEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapValue.size(); i < e; ++i)
         {
-            ssp << remapValue[i].m_pos    << " ";
-            ssv << remapValue[i].m_value  << " ";
-            ssi << remapValue[i].m_interp << " ";
+            positions.append(remapValue[i].m_pos);
+            values.append(remapValue[i].m_value);
+            interps.append(remapValue[i].m_interp);
         }
 
-        shaderParams.insert("in_value_Position"  , ssp.str().c_str());
-        shaderParams.insert("in_value_FloatValue", ssv.str().c_str());
-        shaderParams.insert("in_value_Interp"    , ssi.str().c_str());
+        positions.insert(shaderParams, "in_value_Position");
+        values.insert(shaderParams, "in_value_FloatValue");
+        interps.insert(shaderParams, "in_value_Interp");
     }
     else if (
         paramInfo.paramName == "in_hue_FloatValue" ||
@@ -32,6 +32,7 @@
 // appleseed-maya headers.
 #include "appleseedmaya/attributeutils.h"
 #include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/paramencoder.h"
 #include "appleseedmaya/shadingnodemetadata.h"
 
 // Build options header.
@@ -47,7 +48,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <sstream>
 #include <vector>
 
 namespace asf = foundation;
@@ -149,25 +149,25 @@ void RemapValueExporter::exportParameterValue(
             remapValue.push_back(RemapValueEntry(p, v, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssv;
-        ssv << "float[] ";
+        ParamEncoder values;
+        values.begin("float[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapValue.size(); i < e; ++i)
         {
-            ssp << remapValue[i].m_pos << " ";
-            ssv << remapValue[i].m_value << " ";
-            ssi << remapValue[i].m_interp << " ";
+            positions.append(remapValue[i].m_pos);
+            values.append(remapValue[i].m_value);
+            interps.append(remapValue[i].m_interp);
         }
 
-        shaderParams.insert("in_value_Position"     , ssp.str().c_str());
-        shaderParams.insert("in_value_FloatValue"   , ssv.str().c_str());
-        shaderParams.insert("in_value_Interp"       , ssi.str().c_str());
+        positions.insert(shaderParams, "in_value_Position");
+        values.insert(shaderParams, "in_value_FloatValue");
+        interps.insert(shaderParams, "in_value_Interp");
     }
     else if (paramInfo.paramName == "in_color_Position")
     {
@@ -195,25 +195,25 @@ void RemapValueExporter::exportParameterValue(
             remapColors.push_back(RemapColorsEntry(p, c, in));
         }
 
-        std::stringstream ssp;
-        ssp << "float[] ";
+        ParamEncoder positions;
+        positions.begin("float[]");
 
-        std::stringstream ssc;
-        ssc<< "color[] ";
+        ParamEncoder values;
+        values.begin("color[]");
 
-        std::stringstream ssi;
-        ssi << "int[] ";
+        ParamEncoder interps;
+        interps.begin("int[]");
 
         for (size_t i = 0, e = remapColors.size(); i < e; ++i)
         {
-            ssp << remapColors[i].m_pos << " ";
-            ssc << remapColors[i].m_color.r << " " << remapColors[i].m_color.g << " " << remapColors[i].m_color.b << " ";
-            ssi << remapColors[i].m_interp << " ";
+            positions.append(remapColors[i].m_pos);
+            values.append(remapColors[i].m_color.r).append(remapColors[i].m_color.g).append(remapColors[i].m_color.b);
+            interps.append(remapColors[i].m_interp);
         }
 
-        shaderParams.insert("in_color_Position"     , ssp.str().c_str());
-        shaderParams.insert("in_color_Color"   , ssc.str().c_str());
-        shaderParams.insert("in_color_Interp"       , ssi.str().c_str());
+        positions.insert(shaderParams, "in_color_Position");
+        values.insert(shaderParams, "in_color_Color");
+        interps.insert(shaderParams, "in_color_Interp");
     }
     else if (
         paramInfo.paramName == "in_value_FloatValue" ||
@@ -70,6 +70,11 @@ ShadingEngineExporter::~ShadingEngineExporter()
     }
 }
 
+MObject ShadingEngineExporter::node() const
+{
+    return m_object;
+}
+
 void ShadingEngineExporter::createExporters(const AppleseedSession::IExporterFactory& exporter_factory)
 {
     MFnDependencyNode depNodeFn(m_object);
@@ -138,3 +143,20 @@ void ShadingEngineExporter::flushEntities()
 
     m_mainAssembly.materials().insert(m_material.release());
 }
+
+void ShadingEngineExporter::removeEntities()
+{
+    if (m_material.get())
+    {
+        m_mainAssembly.materials().remove(m_material.get());
+        m_material.reset();
+    }
+
+    if (m_surfaceShader.get())
+    {
+        m_mainAssembly.surface_shaders().remove(m_surfaceShader.get());
+        m_surfaceShader.reset();
+    }
+
+    m_surfaceNetworkExporter.reset();
+}
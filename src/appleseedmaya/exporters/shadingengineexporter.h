@@ -61,6 +61,9 @@ class ShadingEngineExporter
   public:
     ~ShadingEngineExporter();
 
+    // Return the Maya shading engine node.
+    MObject node() const;
+
     // Create any extra exporter needed by this exporter (shading networks, ...).
     void createExporters(const AppleseedSession::IExporterFactory& exporter_factory);
 
@@ -70,6 +73,9 @@ class ShadingEngineExporter
     // Flush entities to the renderer.
     void flushEntities();
 
+    // Remove the entities from the project, before exporting the shading engine again.
+    void removeEntities();
+
   private:
     friend class NodeExporterFactory;
 
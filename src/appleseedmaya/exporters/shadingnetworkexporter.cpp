@@ -51,6 +51,11 @@
 
 // Standard headers.
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace asf = foundation;
 namespace asr = renderer;
@@ -77,6 +82,60 @@ namespace
             nodeTypeName.asChar());
         return status;
     }
+
+    struct ShaderDeclaration
+    {
+        std::string     m_type;
+        std::string     m_shader;
+        std::string     m_layer;
+        asr::ParamArray m_params;
+    };
+
+    struct ShaderConnectionDeclaration
+    {
+        std::string     m_srcLayer;
+        std::string     m_srcParam;
+        std::string     m_dstLayer;
+        std::string     m_dstParam;
+    };
+
+    // Maya utility nodes whose outputs only depend on their inputs,
+    // and not on the shading point.
+    const char* PureUtilityNodeTypes[] =
+    {
+        "blendColors",
+        "clamp",
+        "condition",
+        "contrast",
+        "gammaCorrect",
+        "hsvToRgb",
+        "luminance",
+        "multiplyDivide",
+        "plusMinusAverage",
+        "remapColor",
+        "remapHsv",
+        "remapValue",
+        "reverse",
+        "rgbToHsv",
+        "setRange"
+    };
+
+    bool isPureUtilityNodeType(const MString& typeName)
+    {
+        for (size_t i = 0, e = sizeof(PureUtilityNodeTypes) / sizeof(PureUtilityNodeTypes[0]); i < e; ++i)
+        {
+            if (typeName == PureUtilityNodeTypes[i])
+                return true;
+        }
+
+        return false;
+    }
+
+    bool foldConstantsEnabled()
+    {
+        const char* value = getenv("APPLESEED_MAYA_FOLD_SHADING_NODES");
+        return value == nullptr || strcmp(value, "0") != 0;
+    }
 }
 
 ShadingNetworkExporter::ShadingNetworkExporter(
@@ -87,20 +146,164 @@ ShadingNetworkExporter::ShadingNetworkExporter(
     AppleseedSession::SessionMode sessionMode)
   : m_context(context)
   , m_sessionMode(sessionMode)
+  , m_foldConstants(sessionMode != AppleseedSession::ProgressiveRenderSession && foldConstantsEnabled())
   , m_object(object)
   , m_outputPlug(outputPlug)
   , m_mainAssembly(mainAssembly)
+  , m_foldedLayerCount(0)
 {
 }
 
 ShadingNetworkExporter::~ShadingNetworkExporter()
 {
-    if (m_sessionMode == AppleseedSession::ProgressiveRenderSession)
+    if (m_sessionMode == AppleseedSession::ProgressiveRenderSession && m_shaderGroup.get())
         m_mainAssembly.shader_groups().remove(m_shaderGroup.get());
 }
 
+void ShadingNetworkExporter::hashShaderGroup(const asr::ShaderGroup& shaderGroup, MurmurHash& hash)
+{
+    // Layers are named after the Maya nodes, they are hashed by their position instead.
+    std::map<std::string, size_t> layers;
+
+    const asr::ShaderContainer& shaders = shaderGroup.shaders();
+    for (auto it = shaders.begin(), e = shaders.end(); it != e; ++it)
+    {
+        const size_t layerIndex = layers.size();
+        layers[it->get_layer()] = layerIndex;
+
+        hash.append(it->get_type());
+        hash.append(it->get_shader());
+        hash.append(it->get_parameters());
+    }
+
+    const asr::ShaderConnectionContainer& connections = shaderGroup.shader_connections();
+    for (auto it = connections.begin(), e = connections.end(); it != e; ++it)
+    {
+        hash.append(layers[it->get_src_layer()]);
+        hash.append(it->get_src_param());
+        hash.append(layers[it->get_dst_layer()]);
+        hash.append(it->get_dst_param());
+    }
+}
+
+void ShadingNetworkExporter::removeEntities()
+{
+    if (m_shaderGroup.get())
+    {
+        m_mainAssembly.shader_groups().remove(m_shaderGroup.get());
+        m_shaderGroup.reset();
+    }
+
+    m_sharedShaderGroupName.clear();
+
+    m_nodeExporters.clear();
+    m_namesToExporters.clear();
+    m_foldedLayerCount = 0;
+}
+
+bool ShadingNetworkExporter::updateShaderParameters(
+    const MString&      nodeName,
+    const MPlugArray&   plugs)
+{
+    ShadingNodeExporterMap::const_iterator exporterIt = m_namesToExporters.find(nodeName);
+    if (exporterIt == m_namesToExporters.end() || m_shaderGroup.get() == nullptr)
+        return false;
+
+    // Folded nodes have no shader to update.
+    if (exporterIt->second == nullptr)
+        return false;
+
+    // Shaders can't be edited once added to a shader group, so the group is
+    // filled again with the same shaders and connections, and the new parameter
+    // values of the edited node's shader. The materials referencing the group
+    // by name and the node exporters referencing it are unaffected.
+    std::vector<ShaderDeclaration> shaders;
+    bool foundLayer = false;
+
+    const asr::ShaderContainer& shaderContainer = m_shaderGroup->shaders();
+    for (asr::ShaderContainer::const_iterator i = shaderContainer.begin(), e = shaderContainer.end(); i != e; ++i)
+    {
+        ShaderDeclaration shader;
+        shader.m_type = i->get_type();
+        shader.m_shader = i->get_shader();
+        shader.m_layer = i->get_layer();
+        shader.m_params = i->get_parameters();
+
+        if (shader.m_layer == nodeName.asChar())
+        {
+            if (!exporterIt->second->updateShaderParameters(plugs, shader.m_params))
+                return false;
+
+            foundLayer = true;
+        }
+
+        shaders.push_back(shader);
+    }
+
+    if (!foundLayer)
+        return false;
+
+    std::vector<ShaderConnectionDeclaration> connections;
+
+    const asr::ShaderConnectionContainer& connectionContainer = m_shaderGroup->shader_connections();
+    for (asr::ShaderConnectionContainer::const_iterator i = connectionContainer.begin(), e = connectionContainer.end(); i != e; ++i)
+    {
+        ShaderConnectionDeclaration connection;
+        connection.m_srcLayer = i->get_src_layer();
+        connection.m_srcParam = i->get_src_param();
+        connection.m_dstLayer = i->get_dst_layer();
+        connection.m_dstParam = i->get_dst_param();
+        connections.push_back(connection);
+    }
+
+    m_shaderGroup->clear();
+
+    for (size_t i = 0, e = shaders.size(); i < e; ++i)
+    {
+        m_shaderGroup->add_shader(
+            shaders[i].m_type.c_str(),
+            shaders[i].m_shader.c_str(),
+            shaders[i].m_layer.c_str(),
+            shaders[i].m_params);
+    }
+
+    for (size_t i = 0, e = connections.size(); i < e; ++i)
+    {
+        m_shaderGroup->add_connection(
+            connections[i].m_srcLayer.c_str(),
+            connections[i].m_srcParam.c_str(),
+            connections[i].m_dstLayer.c_str(),
+            connections[i].m_dstParam.c_str());
+    }
+
+    m_shaderGroup->bump_version_id();
+    return true;
+}
+
+bool ShadingNetworkExporter::containsNode(const MString& nodeName) const
+{
+    return m_namesToExporters.count(nodeName) != 0;
+}
+
+MObjectArray ShadingNetworkExporter::nodes() const
+{
+    MObjectArray nodes;
+    for (size_t i = 0, e = m_nodeExporters.size(); i < e; ++i)
+        nodes.append(m_nodeExporters[i]->node());
+
+    return nodes;
+}
+
+size_t ShadingNetworkExporter::foldedLayerCount() const
+{
+    return m_foldedLayerCount;
+}
+
 MString ShadingNetworkExporter::shaderGroupName() const
 {
+    if (m_sharedShaderGroupName.length() != 0)
+        return m_sharedShaderGroupName;
+
     assert(m_shaderGroup.get());
     return m_shaderGroup->get_name();
 }
@@ -112,13 +315,50 @@ void ShadingNetworkExporter::createEntities()
     m_shaderGroup = asr::ShaderGroupFactory::create(shaderGroupName.asChar());
 
     createShaderNodeExporters(m_object);
+    m_foldableNodes.clear();
 
     // Create shader entities
     for (size_t i = 0, e = m_nodeExporters.size(); i < e; ++i)
+    {
         m_nodeExporters[i]->createEntities(m_namesToExporters);
+        m_foldedLayerCount += m_nodeExporters[i]->foldedAdaptorCount();
+    }
 }
 
 void ShadingNetworkExporter::flushEntities()
+{
+    addContextShaders();
+
+    insertEntityWithUniqueName(
+        m_mainAssembly.shader_groups(),
+        m_shaderGroup);
+}
+
+bool ShadingNetworkExporter::flushEntities(ShaderGroupHashMap& flushedShaderGroups)
+{
+    addContextShaders();
+
+    MurmurHash hash;
+    hashShaderGroup(*m_shaderGroup, hash);
+
+    auto it = flushedShaderGroups.find(hash);
+    if (it != flushedShaderGroups.end())
+    {
+        // Reference the identical shader group instead of adding this one.
+        m_sharedShaderGroupName = it->second;
+        m_shaderGroup.reset();
+        return true;
+    }
+
+    insertEntityWithUniqueName(
+        m_mainAssembly.shader_groups(),
+        m_shaderGroup);
+
+    flushedShaderGroups[hash] = m_shaderGroup->get_name();
+    return false;
+}
+
+void ShadingNetworkExporter::addContextShaders()
 {
     // Add any extra shader and or connections, depending on the context.
     switch (m_context)
@@ -190,10 +430,6 @@ void ShadingNetworkExporter::flushEntities()
             assert(false);
         break;
     }
-
-    insertEntityWithUniqueName(
-        m_mainAssembly.shader_groups(),
-        m_shaderGroup);
 }
 
 void ShadingNetworkExporter::createShaderNodeExporters(const MObject& node)
@@ -208,6 +444,15 @@ void ShadingNetworkExporter::createShaderNodeExporters(const MObject& node)
         return;
     }
 
+    if (isFoldable(node))
+    {
+        // Downstream shaders get the value of the node as a constant parameter.
+        m_namesToExporters[depNodeFn.name()] = nullptr;
+        ++m_foldedLayerCount;
+        RENDERER_LOG_DEBUG("Folded constant shading node %s.", depNodeFn.name().asChar());
+        return;
+    }
+
     const OSLShaderInfo* shaderInfo = ShadingNodeRegistry::getShaderInfo(depNodeFn.typeName());
     if (shaderInfo)
     {
@@ -220,7 +465,7 @@ void ShadingNetworkExporter::createShaderNodeExporters(const MObject& node)
             if (paramInfo.isOutput)
                 continue;
 
-            MPlug plug = depNodeFn.findPlug(paramInfo.mayaAttributeName, false, &status);
+            MPlug plug = paramInfo.findPlug(depNodeFn, &status);
             if (!status)
             {
                 RENDERER_LOG_WARNING(
@@ -284,3 +529,64 @@ void ShadingNetworkExporter::createShaderNodeExporters(const MObject& node)
             depNodeFn.typeName().asChar());
     }
 }
+
+bool ShadingNetworkExporter::isFoldable(const MObject& node)
+{
+    // Interactive edits update the shaders of individual nodes,
+    // so folding is disabled in progressive sessions.
+    if (!m_foldConstants || node == m_object)
+        return false;
+
+    MFnDependencyNode depNodeFn(node);
+    if (!isPureUtilityNodeType(depNodeFn.typeName()))
+        return false;
+
+    auto it = m_foldableNodes.find(depNodeFn.name());
+    if (it != m_foldableNodes.end())
+        return it->second;
+
+    // Nodes in a dependency cycle are reached again while their inputs are
+    // checked, they can't be folded. The final result is stored below.
+    m_foldableNodes[depNodeFn.name()] = false;
+
+    bool foldable = true;
+
+    // Check the nodes connected to the inputs, including children and elements.
+    MPlugArray plugs;
+    depNodeFn.getConnections(plugs);
+    for (unsigned int i = 0, e = plugs.length(); i < e && foldable; ++i)
+    {
+        MPlugArray srcPlugs;
+        plugs[i].connectedTo(srcPlugs, true, false);
+
+        for (unsigned int j = 0, je = srcPlugs.length(); j < je; ++j)
+        {
+            if (!isFoldable(srcPlugs[j].node()))
+            {
+                foldable = false;
+                break;
+            }
+        }
+
+        // Params defaulting to shader globals are not exported,
+        // so they can't receive the value of a folded node.
+        MPlugArray dstPlugs;
+        plugs[i].connectedTo(dstPlugs, false, true);
+
+        for (unsigned int j = 0, je = dstPlugs.length(); j < je && foldable; ++j)
+        {
+            MFnDependencyNode dstDepNodeFn(dstPlugs[j].node());
+            const OSLShaderInfo* shaderInfo = ShadingNodeRegistry::getShaderInfo(dstDepNodeFn.typeName());
+            if (shaderInfo == nullptr)
+                continue;
+
+            const MPlug dstPlug = dstPlugs[j].isChild() ? dstPlugs[j].parent() : dstPlugs[j];
+            const OSLParamInfo* paramInfo = shaderInfo->findParam(dstPlug);
+            if (paramInfo && !paramInfo->validDefault)
+                foldable = false;
+        }
+    }
+
+    m_foldableNodes[depNodeFn.name()] = foldable;
+    return foldable;
+}
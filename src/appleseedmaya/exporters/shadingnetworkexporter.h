@@ -35,6 +35,7 @@
 // appleseed-maya headers.
 #include "appleseedmaya/appleseedsession.h"
 #include "appleseedmaya/exporters/shadingnodeexporterfwd.h"
+#include "appleseedmaya/murmurhash.h"
 #include "appleseedmaya/utils.h"
 
 // Build options header.
@@ -49,7 +50,9 @@
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
 #include <maya/MObject.h>
+#include <maya/MObjectArray.h>
 #include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
 #include <maya/MString.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
@@ -64,9 +67,18 @@ class ShadingNetworkExporter
   : public foundation::NonCopyable
 {
   public:
+    // Names of the flushed shader groups, indexed by the hash of their content.
+    typedef std::map<MurmurHash, MString> ShaderGroupHashMap;
+
     ~ShadingNetworkExporter();
 
-    // Return the name of the appleseed shader group created by this exporter.
+    // Hash the content of a shader group: shader types, parameter values and connections.
+    // Layers are hashed by position, so that networks that differ only by the names
+    // of their Maya nodes have the same hash.
+    static void hashShaderGroup(const renderer::ShaderGroup& shaderGroup, MurmurHash& hash);
+
+    // Return the name of the appleseed shader group created by this exporter,
+    // or of the identical shader group it shares.
     MString shaderGroupName() const;
 
     // Create appleseed entities.
@@ -75,6 +87,29 @@ class ShadingNetworkExporter
     // Flush entities to the renderer.
     void flushEntities();
 
+    // Flush entities to the renderer, or share the shader group of a network
+    // with the same content if one was flushed already.
+    // Return true if the shader group is shared.
+    bool flushEntities(ShaderGroupHashMap& flushedShaderGroups);
+
+    // Remove the entities from the project, before exporting the network again.
+    void removeEntities();
+
+    // Update the parameters of a shading node of this network after its plugs were
+    // edited, keeping the other shaders and the connections of the shader group.
+    // Return false if the network has to be exported again.
+    bool updateShaderParameters(const MString& nodeName, const MPlugArray& plugs);
+
+    // Return true if a Maya node is part of this shading network.
+    bool containsNode(const MString& nodeName) const;
+
+    // Return the Maya nodes of this shading network.
+    MObjectArray nodes() const;
+
+    // Return the number of shader layers removed by folding
+    // constant utility nodes into the parameters of their consumers.
+    size_t foldedLayerCount() const;
+
   private:
     friend class NodeExporterFactory;
 
@@ -87,14 +122,26 @@ class ShadingNetworkExporter
 
     void createShaderNodeExporters(const MObject& node);
 
+    // Return true if a node is a pure utility node whose inputs are constant,
+    // or connected to other foldable nodes. Maya evaluates the value of its
+    // outputs when the parameters of the downstream shaders are exported.
+    bool isFoldable(const MObject& node);
+
+    // Add the shaders and connections needed by the context of the network.
+    void addContextShaders();
+
     ShadingNetworkContext                       m_context;
     AppleseedSession::SessionMode               m_sessionMode;
+    bool                                        m_foldConstants;
     MObject                                     m_object;
     MPlug                                       m_outputPlug;
     renderer::Assembly&                         m_mainAssembly;
     AppleseedEntityPtr<renderer::ShaderGroup>   m_shaderGroup;
+    MString                                     m_sharedShaderGroupName;
     std::vector<ShadingNodeExporterPtr>         m_nodeExporters;
     ShadingNodeExporterMap                      m_namesToExporters;
+    std::map<MString, bool, MStringCompareLess> m_foldableNodes;
+    size_t                                      m_foldedLayerCount;
 };
 
 #endif  // !APPLESEED_MAYA_EXPORTERS_SHADINGNETWORKEXPORTER_H
@@ -58,7 +58,6 @@
 
 // Standard headers.
 #include <algorithm>
-#include <sstream>
 #include <vector>
 
 namespace asf = foundation;
@@ -101,6 +100,7 @@ ShadingNodeExporter::ShadingNodeExporter(
     asr::ShaderGroup&                   shaderGroup)
   : m_object(object)
   , m_shaderGroup(shaderGroup)
+  , m_foldedAdaptorCount(0)
 {
 }
 
@@ -127,7 +127,7 @@ void ShadingNodeExporter::createEntities(ShadingNodeExporterMap& exporters)
         if (paramInfo.isOutput)
             continue;
 
-        MPlug plug = depNodeFn.findPlug(paramInfo.mayaAttributeName, false, &status);
+        MPlug plug = paramInfo.findPlug(depNodeFn, &status);
         if (!status)
             continue;
 
@@ -151,6 +151,10 @@ void ShadingNodeExporter::createEntities(ShadingNodeExporterMap& exporters)
                     ShadingNodeExporter* srcNodeExporter = getSrcPlugAndExporter(plug, exporters, srcPlug);
                     if (!srcNodeExporter)
                     {
+                        // The value of folded nodes was exported with the other params.
+                        if (isFoldedNode(exporters, srcPlug.node()))
+                            continue;
+
                         MFnDependencyNode srcDepNodeFn(srcPlug.node());
                         RENDERER_LOG_WARNING(
                             "Skipping connections to unsupported shading node %s",
@@ -262,7 +266,7 @@ void ShadingNodeExporter::createEntities(ShadingNodeExporterMap& exporters)
         if (paramInfo.isOutput)
             continue;
 
-        MPlug plug = depNodeFn.findPlug(paramInfo.mayaAttributeName, false, &status);
+        MPlug plug = paramInfo.findPlug(depNodeFn, &status);
         if (!status)
         {
             RENDERER_LOG_WARNING(
@@ -278,6 +282,10 @@ void ShadingNodeExporter::createEntities(ShadingNodeExporterMap& exporters)
             ShadingNodeExporter* srcNodeExporter = getSrcPlugAndExporter(plug, exporters, srcPlug);
             if (!srcNodeExporter)
             {
+                // The value of folded nodes was exported with the other params.
+                if (isFoldedNode(exporters, srcPlug.node()))
+                    continue;
+
                 MFnDependencyNode srcDepNodeFn(srcPlug.node());
                 RENDERER_LOG_WARNING(
                     "Skipping connections to unsupported shading node %s",
@@ -417,6 +425,52 @@ bool ShadingNodeExporter::layerAndParamNameFromPlug(
     return false;
 }
 
+bool ShadingNodeExporter::updateShaderParameters(
+    const MPlugArray&                   plugs,
+    asr::ParamArray&                    shaderParams) const
+{
+    const OSLShaderInfo& shaderInfo = getShaderInfo();
+    bool exportAllParams = false;
+
+    for (unsigned int i = 0, e = plugs.length(); i < e; ++i)
+    {
+        MPlug plug = plugs[i];
+
+        // The values of connected plugs come from other shaders.
+        if (hasConnections(plug, true, false))
+            continue;
+
+        // Component plugs are exported with their parent.
+        if (plug.isChild())
+            plug = plug.parent();
+
+        const OSLParamInfo* paramInfo = shaderInfo.findParam(plug);
+        if (paramInfo == nullptr)
+        {
+            // Attributes like ramp entries are exported to several parameters.
+            exportAllParams = true;
+            continue;
+        }
+
+        if (paramInfo->isOutput || !paramInfo->validDefault)
+            continue;
+
+        // Partially connected parameters are exported to adaptor shaders.
+        if (plug.isCompound() && hasChildrenConnections(plug, true, false))
+            return false;
+
+        if (plug.isArray() && hasElementConnections(plug, true, false))
+            return false;
+
+        exportParameterValue(plug, *paramInfo, shaderParams);
+    }
+
+    if (exportAllParams)
+        exportShaderParameters(shaderInfo, shaderParams);
+
+    return true;
+}
+
 void ShadingNodeExporter::exportShaderParameters(
     const OSLShaderInfo&                shaderInfo,
     asr::ParamArray&                    shaderParams) const
@@ -427,7 +481,7 @@ void ShadingNodeExporter::exportShaderParameters(
     for (size_t i = 0, e = shaderInfo.paramInfo.size(); i < e; ++i)
     {
         const OSLParamInfo& paramInfo = shaderInfo.paramInfo[i];
-        MPlug plug = depNodeFn.findPlug(paramInfo.mayaAttributeName, false, &status);
+        MPlug plug = paramInfo.findPlug(depNodeFn, &status);
         if (!status)
         {
             RENDERER_LOG_WARNING(
@@ -484,13 +538,16 @@ void ShadingNodeExporter::exportValue(
         "Exporting shading node attr %s.",
         paramInfo.mayaAttributeName.asChar());
 
-    std::stringstream ss;
+    bool valid = false;
 
     if (paramInfo.paramType == "color")
     {
         MColor value;
         if (AttributeUtils::get(plug, value))
-            ss << "color " << value.r << " " << value.g << " " << value.b;
+        {
+            m_encoder.begin("color").append(value.r).append(value.g).append(value.b);
+            valid = true;
+        }
     }
     else if (paramInfo.paramType == "float")
     {
@@ -498,25 +555,37 @@ void ShadingNodeExporter::exportValue(
         {
             MAngle value(0.0f, MAngle::kDegrees);
             if (AttributeUtils::get(plug, value))
-                ss << "float " << value.asDegrees();
+            {
+                m_encoder.begin("float").append(static_cast<float>(value.asDegrees()));
+                valid = true;
+            }
         }
         else
         {
             float value;
             if (AttributeUtils::get(plug, value))
-                ss << "float " << value;
+            {
+                m_encoder.begin("float").append(value);
+                valid = true;
+            }
         }
     }
     else if (paramInfo.paramType == "int")
     {
         int value;
         if (AttributeUtils::get(plug, value))
-            ss << "int " << value;
+        {
+            m_encoder.begin("int").append(value);
+            valid = true;
+        }
         else
         {
             bool boolValue;
             if (AttributeUtils::get(plug, boolValue))
-                ss << "int " << (boolValue ? "1" : "0"); // ?: has lower precedence than <<
+            {
+                m_encoder.begin("int").append(boolValue ? 1 : 0);
+                valid = true;
+            }
         }
     }
     else if (paramInfo.paramType == "matrix")
@@ -524,23 +593,37 @@ void ShadingNodeExporter::exportValue(
         MMatrix matrixValue;
         if (AttributeUtils::get(plug, matrixValue))
         {
-            ss << "matrix ";
+            m_encoder.begin("matrix");
             for (int i = 0; i < 4; ++i)
                 for (int j = 0; j < 4; ++j)
-                    ss << matrixValue[i][j] << " ";
+                    m_encoder.append(static_cast<float>(matrixValue[i][j]));
+
+            valid = true;
         }
     }
     else if (paramInfo.paramType == "normal")
     {
         MVector value;
         if (AttributeUtils::get(plug, value))
-            ss << "normal " << value.z << " " << value.y << " " << value.z;
+        {
+            m_encoder.begin("normal")
+                .append(static_cast<float>(value.z))
+                .append(static_cast<float>(value.y))
+                .append(static_cast<float>(value.z));
+            valid = true;
+        }
     }
     else if (paramInfo.paramType == "point")
     {
         MPoint value;
         if (AttributeUtils::get(plug, value))
-            ss << "point " << value.z << " " << value.y << " " << value.z;
+        {
+            m_encoder.begin("point")
+                .append(static_cast<float>(value.z))
+                .append(static_cast<float>(value.y))
+                .append(static_cast<float>(value.z));
+            valid = true;
+        }
     }
     else if (paramInfo.paramType == "string")
     {
@@ -550,20 +633,30 @@ void ShadingNodeExporter::exportValue(
             MFnEnumAttribute fnEnumAttr(attr);
             short shortValue = plug.asShort();
             MString value = fnEnumAttr.fieldName(shortValue);
-            ss << "string " << value;
+            m_encoder.begin("string").append(value.asChar());
+            valid = true;
         }
         else
         {
             MString value;
             if (AttributeUtils::get(plug, value))
-                ss << "string " << value;
+            {
+                m_encoder.begin("string").append(value.asChar());
+                valid = true;
+            }
         }
     }
     else if (paramInfo.paramType == "vector")
     {
         MVector value;
         if (AttributeUtils::get(plug, value))
-            ss << "vector " << value.x << " " << value.y << " " << value.z;
+        {
+            m_encoder.begin("vector")
+                .append(static_cast<float>(value.x))
+                .append(static_cast<float>(value.y))
+                .append(static_cast<float>(value.z));
+            valid = true;
+        }
     }
     else
     {
@@ -573,9 +666,8 @@ void ShadingNodeExporter::exportValue(
             paramInfo.paramType.asChar());
     }
 
-    std::string valueAsString = ss.str();
-    if (!valueAsString.empty())
-        shaderParams.insert(paramInfo.paramName.asChar(), valueAsString.c_str());
+    if (valid)
+        m_encoder.insert(shaderParams, paramInfo.paramName.asChar());
 }
 
 void ShadingNodeExporter::exportArrayValue(
@@ -590,13 +682,11 @@ void ShadingNodeExporter::exportArrayValue(
     MStatus status;
     bool valid = true;
 
-    std::stringstream ss;
-
     if (strncmp(paramInfo.paramType.asChar(), "float[", 5) == 0)
     {
         assert(plug.isCompound());
 
-        ss << "float[] ";
+        m_encoder.begin("float[]");
         for (unsigned int i = 0, e = plug.numChildren(); i < e; ++i)
         {
             MPlug childPlug = plug.child(i, &status);
@@ -604,7 +694,7 @@ void ShadingNodeExporter::exportArrayValue(
             {
                 float value;
                 if (AttributeUtils::get(childPlug, value))
-                    ss << value << " ";
+                    m_encoder.append(value);
                 else
                     valid = false;
             }
@@ -616,7 +706,7 @@ void ShadingNodeExporter::exportArrayValue(
     {
         assert(plug.isCompound());
 
-        ss << "int[] ";
+        m_encoder.begin("int[]");
         for (unsigned int i = 0, e = plug.numChildren(); i < e; ++i)
         {
             MPlug childPlug = plug.child(i, &status);
@@ -624,7 +714,7 @@ void ShadingNodeExporter::exportArrayValue(
             {
                 int value;
                 if (AttributeUtils::get(childPlug, value))
-                    ss << value << " ";
+                    m_encoder.append(value);
                 else
                     valid = false;
             }
@@ -642,11 +732,7 @@ void ShadingNodeExporter::exportArrayValue(
     }
 
     if (valid)
-    {
-        std::string valueAsString = ss.str();
-        if (!valueAsString.empty())
-            shaderParams.insert(paramInfo.paramName.asChar(), valueAsString.c_str());
-    }
+        m_encoder.insert(shaderParams, paramInfo.paramName.asChar());
     else
     {
         RENDERER_LOG_WARNING(
@@ -696,8 +782,8 @@ void ShadingNodeExporter::exportRampValue(
     renderer::ParamArray&           shaderParams) const
 {
     MRampAttribute ramp(plug);
-    std::string values;
-    std::string positions;
+    ParamEncoder& values = m_encoder;
+    ParamEncoder positions;
     // std::string basis;
 
     if (paramInfo.paramType == "color[]")
@@ -721,13 +807,13 @@ void ShadingNodeExporter::exportRampValue(
         return;
     }
 
-    shaderParams.insert(paramInfo.paramName.asChar(), values.c_str());
+    values.insert(shaderParams, paramInfo.paramName.asChar());
 
     std::string positionsParamName = asf::replace(
         paramInfo.paramName.asChar(),
         "_values",
         "_positions");
-    shaderParams.insert(positionsParamName.c_str(), positions.c_str());
+    positions.insert(shaderParams, positionsParamName.c_str());
 
     // todo: save basis here...
 }
@@ -737,6 +823,11 @@ MObject ShadingNodeExporter::node() const
     return m_object;
 }
 
+size_t ShadingNodeExporter::foldedAdaptorCount() const
+{
+    return m_foldedAdaptorCount;
+}
+
 bool ShadingNodeExporter::hasConnections(
     const MPlug&                        plug,
     const bool                          asDst,
@@ -818,6 +909,15 @@ ShadingNodeExporter* ShadingNodeExporter::findExporterForNode(
     return nullptr;
 }
 
+bool ShadingNodeExporter::isFoldedNode(
+    const ShadingNodeExporterMap&       exporters,
+    const MObject&                      node) const
+{
+    MFnDependencyNode depNodeFn(node);
+    auto it = exporters.find(depNodeFn.name());
+    return it != exporters.end() && it->second == nullptr;
+}
+
 ShadingNodeExporter* ShadingNodeExporter::getSrcPlugAndExporter(
     const MPlug&                        plug,
     ShadingNodeExporterMap&             exporters,
@@ -867,6 +967,7 @@ void ShadingNodeExporter::createInputFloatCompoundAdaptorShader(
     std::vector<MString> srcLayerNames;
     std::vector<MString> srcParamNames;
     std::vector<size_t>  dstParamIndices;
+    bool foldedChildren = false;
 
     // For each child attribute.
     for (unsigned int i = 0, e = plug.numChildren(); i < e; ++i)
@@ -876,7 +977,25 @@ void ShadingNodeExporter::createInputFloatCompoundAdaptorShader(
         {
             MPlug srcPlug;
             ShadingNodeExporter* srcNodeExporter = getSrcPlugAndExporter(childPlug, exporters, srcPlug);
-            if (!srcNodeExporter)
+            if (srcNodeExporter)
+            {
+                // Find the layer and param names on the other side of the connection.
+                MString srcLayerName;
+                MString srcParam;
+                if (srcNodeExporter->layerAndParamNameFromPlug(srcPlug, srcLayerName, srcParam))
+                {
+                    // We cannot do make a connection now because we don't know
+                    // the name of the destination layer (has not been created yet).
+                    // Save the info we need to make a connection later.
+                    srcLayerNames.push_back(srcLayerName);
+                    srcParamNames.push_back(srcParam);
+                    dstParamIndices.push_back(i);
+                }
+
+                continue;
+            }
+
+            if (!isFoldedNode(exporters, srcPlug.node()))
             {
                 MFnDependencyNode srcDepNodeFn(srcPlug.node());
                 RENDERER_LOG_WARNING(
@@ -885,32 +1004,27 @@ void ShadingNodeExporter::createInputFloatCompoundAdaptorShader(
                 continue;
             }
 
-            // Find the layer and param names on the other side of the connection.
-            MString srcLayerName;
-            MString srcParam;
-            if (srcNodeExporter->layerAndParamNameFromPlug(srcPlug, srcLayerName, srcParam))
-            {
-                // We cannot do make a connection now because we don't know
-                // the name of the destination layer (has not been created yet).
-                // Save the info we need to make a connection later.
-                srcLayerNames.push_back(srcLayerName);
-                srcParamNames.push_back(srcParam);
-                dstParamIndices.push_back(i);
-            }
+            // Maya evaluates the folded node when the child value is read below.
+            foldedChildren = true;
         }
-        else
+
+        // Save the value of this child attribute as a shader param.
+        float value;
+        if (AttributeUtils::get(childPlug, value))
         {
-            // Save the value of this child attribute as a shader param.
-            float value;
-            if (AttributeUtils::get(childPlug, value))
-            {
-                std::stringstream ss;
-                ss << "float " << value;
-                params.insert(shaderParamNames[i], ss.str().c_str());
-            }
+            m_encoder.begin("float").append(value);
+            m_encoder.insert(params, shaderParamNames[i]);
         }
     }
 
+    // If all the connected children were folded, the value of the
+    // compound param, exported with the other params, is already right.
+    if (foldedChildren && dstParamIndices.empty())
+    {
+        ++m_foldedAdaptorCount;
+        return;
+    }
+
     const MString adaptorName = createAdaptorShader(
         shaderName,
         layerName,
@@ -34,6 +34,7 @@
 
 // appleseed-maya headers.
 #include "appleseedmaya/appleseedsession.h"
+#include "appleseedmaya/paramencoder.h"
 #include "appleseedmaya/utils.h"
 
 // Build options header.
@@ -46,6 +47,7 @@
 #include "appleseedmaya/_beginmayaheaders.h"
 #include <maya/MObject.h>
 #include <maya/MPlug.h>
+#include <maya/MPlugArray.h>
 #include <maya/MString.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
@@ -74,6 +76,19 @@ class ShadingNodeExporter
     // Flush entities to the renderer.
     void flushEntities();
 
+    // Return the Maya dependency node.
+    MObject node() const;
+
+    // Return the number of input adaptor shaders not created
+    // because all their connected inputs were folded.
+    size_t foldedAdaptorCount() const;
+
+    // Export again the values of edited plugs to the shader parameters.
+    // Return false if the shading network has to be exported again.
+    bool updateShaderParameters(
+        const MPlugArray&               plugs,
+        renderer::ParamArray&           shaderParams) const;
+
   protected:
     ShadingNodeExporter(
         const MObject&                  object,
@@ -108,8 +123,6 @@ class ShadingNodeExporter
         MString&                        layerName,
         MString&                        paramName);
 
-    MObject node() const;
-
     bool hasConnections(const MPlug& plug, const bool asDst, const bool asSrc) const;
     bool hasChildrenConnections(const MPlug& plug, const bool asDst, const bool asSrc) const;
     bool hasElementConnections(const MPlug& plug, const bool asDst, const bool asSrc) const;
@@ -120,6 +133,10 @@ class ShadingNodeExporter
         ShadingNodeExporterMap&         exporters,
         const MObject&                  node);
 
+    bool isFoldedNode(
+        const ShadingNodeExporterMap&   exporters,
+        const MObject&                  node) const;
+
     ShadingNodeExporter* getSrcPlugAndExporter(
         const MPlug&                    plug,
         ShadingNodeExporterMap&         exporters,
@@ -149,6 +166,8 @@ class ShadingNodeExporter
 
     MObject                         m_object;
     renderer::ShaderGroup&          m_shaderGroup;
+    mutable ParamEncoder            m_encoder;      // reused by all the exported values
+    size_t                          m_foldedAdaptorCount;
 };
 
 #endif  // !APPLESEED_MAYA_EXPORTERS_SHADINGNODEEXPORTER_H
@@ -39,6 +39,7 @@
 class ShadingNodeExporter;
 typedef std::shared_ptr<ShadingNodeExporter> ShadingNodeExporterPtr;
 
+// Nodes folded into constant parameters at export time are mapped to a null exporter.
 typedef std::map<MString, ShadingNodeExporter*, MStringCompareLess> ShadingNodeExporterMap;
 
 #endif  // !APPLESEED_MAYA_EXPORTERS_SHADINGNODEEXPORTERFWD_H
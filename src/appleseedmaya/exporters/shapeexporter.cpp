@@ -52,7 +52,7 @@ ShapeExporter::ShapeExporter(
 
 ShapeExporter::~ShapeExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         assert(m_objectAssembly.get());
 
@@ -99,9 +99,9 @@ void ShapeExporter::flushEntities()
 {
     m_transformSequence.optimize();
 
-    // Create an assembly for this object if needed (instanced or xform motion blur).
+    // Create an assembly for this object if needed (instanced, xform motion blur or editable).
     const bool needsAssembly = m_numInstances > 0 || m_transformSequence.size() > 1;
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession || needsAssembly)
+    if (removeEntitiesOnDestruction() || needsAssembly)
     {
         const MString assemblyName = appleseedName() + MString("_assembly");
         m_objectAssembly.reset(
@@ -123,6 +123,20 @@ void ShapeExporter::flushEntities()
     }
 }
 
+bool ShapeExporter::updateTransform()
+{
+    // Only objects with their own assembly instance can be moved.
+    if (m_objectAssemblyInstance.get() == nullptr || m_numInstances != 0)
+        return false;
+
+    m_transformSequence.clear();
+    exportTransformMotionStep(0.0f);
+
+    m_objectAssemblyInstance->transform_sequence() = m_transformSequence;
+    m_objectAssemblyInstance->bump_version_id();
+    return true;
+}
+
 void ShapeExporter::shapeAttributesToParams(renderer::ParamArray& params)
 {
 }
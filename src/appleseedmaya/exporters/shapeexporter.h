@@ -55,6 +55,8 @@ class ShapeExporter
 
     void flushEntities() override = 0;
 
+    bool updateTransform() override;
+
     // Return true if this object can be instanced.
     virtual bool supportsInstancing() const;
 
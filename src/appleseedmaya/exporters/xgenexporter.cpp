@@ -75,7 +75,7 @@ XGenExporter::XGenExporter(
 
 XGenExporter::~XGenExporter()
 {
-    if (sessionMode() == AppleseedSession::ProgressiveRenderSession)
+    if (removeEntitiesOnDestruction())
     {
         mainAssembly().assemblies().remove(m_assembly.get());
         mainAssembly().assembly_instances().remove(m_assemblyInstance.get());
@@ -266,3 +266,16 @@ void XGenExporter::flushEntities()
     m_assemblyInstance->transform_sequence() = m_transformSequence;
     mainAssembly().assembly_instances().insert(m_assemblyInstance.release());
 }
+
+bool XGenExporter::updateTransform()
+{
+    if (m_assemblyInstance.get() == nullptr)
+        return false;
+
+    m_transformSequence.clear();
+    exportTransformMotionStep(0.0f);
+
+    m_assemblyInstance->transform_sequence() = m_transformSequence;
+    m_assemblyInstance->bump_version_id();
+    return true;
+}
@@ -62,6 +62,8 @@ class XGenExporter
 
     void flushEntities() override;
 
+    bool updateTransform() override;
+
   private:
     XGenExporter(
       const MDagPath&                                   path,
@@ -0,0 +1,279 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "exportstatistics.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/tracer.h"
+#include "appleseedmaya/utils.h"
+
+// Standard headers.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::string g_lastReport;
+}
+
+ExportStatistics::ExporterTypeStats::ExporterTypeStats()
+  : m_count(0)
+{
+}
+
+ExportStatistics::ExportStatistics()
+  : m_start(Clock::now())
+  , m_totalSeconds(0.0)
+  , m_geometryBytes(0)
+  , m_startRSS(ExportStatisticsReport::currentRSS())
+  , m_endRSS(0)
+  , m_processPeakRSS(0)
+{
+}
+
+void ExportStatistics::addPhase(const std::string& name, const double seconds)
+{
+    Phase phase;
+    phase.m_name = name;
+    phase.m_seconds = seconds;
+    m_phases.push_back(phase);
+}
+
+void ExportStatistics::addPhaseValue(const char* name, const double value)
+{
+    if (!m_phases.empty())
+        m_phases.back().m_values.push_back(std::make_pair(std::string(name), value));
+}
+
+void ExportStatistics::addExporterTime(
+    const std::string&  exporterType,
+    const char*         step,
+    const double        seconds)
+{
+    m_exporterTypes[exporterType].m_steps[step] += seconds;
+}
+
+void ExportStatistics::addExporter(const std::string& exporterType)
+{
+    m_exporterTypes[exporterType].m_count++;
+}
+
+void ExportStatistics::addGeometryBytes(const size_t bytes)
+{
+    m_geometryBytes += bytes;
+}
+
+void ExportStatistics::finish(const char* sessionName, const std::string& projectName)
+{
+    m_totalSeconds = secondsSince(m_start);
+    m_sessionName = sessionName;
+    m_projectName = projectName;
+    m_endRSS = ExportStatisticsReport::currentRSS();
+    m_processPeakRSS = ExportStatisticsReport::peakRSS();
+}
+
+std::string ExportStatistics::toJSON() const
+{
+    std::stringstream ss;
+
+    ss << "{\n";
+    ss << "  \"session\": ";
+    writeJSONString(ss, m_sessionName);
+    ss << ",\n  \"project\": ";
+    writeJSONString(ss, m_projectName);
+    ss << ",\n  \"totalTime\": " << m_totalSeconds;
+    ss << ",\n  \"startRSS\": " << m_startRSS;
+    ss << ",\n  \"endRSS\": " << m_endRSS;
+    ss << ",\n  \"rssIncrease\": " << static_cast<long long>(m_endRSS) - static_cast<long long>(m_startRSS);
+    ss << ",\n  \"processPeakRSS\": " << m_processPeakRSS;
+    ss << ",\n  \"geometryBytes\": " << m_geometryBytes.load();
+
+    ss << ",\n  \"phases\": [";
+    for (size_t i = 0, e = m_phases.size(); i < e; ++i)
+    {
+        const Phase& phase = m_phases[i];
+
+        ss << (i == 0 ? "\n" : ",\n") << "    { \"name\": ";
+        writeJSONString(ss, phase.m_name);
+        ss << ", \"time\": " << phase.m_seconds;
+
+        for (size_t j = 0, je = phase.m_values.size(); j < je; ++j)
+        {
+            ss << ", ";
+            writeJSONString(ss, phase.m_values[j].first);
+            ss << ": " << phase.m_values[j].second;
+        }
+
+        ss << " }";
+    }
+    ss << "\n  ]";
+
+    ss << ",\n  \"exporters\": {";
+    for (auto it = m_exporterTypes.begin(), e = m_exporterTypes.end(); it != e; ++it)
+    {
+        ss << (it == m_exporterTypes.begin() ? "\n" : ",\n") << "    ";
+        writeJSONString(ss, it->first);
+        ss << ": { \"count\": " << it->second.m_count;
+
+        for (auto stepIt = it->second.m_steps.begin(), stepE = it->second.m_steps.end(); stepIt != stepE; ++stepIt)
+        {
+            ss << ", ";
+            writeJSONString(ss, stepIt->first);
+            ss << ": " << stepIt->second;
+        }
+
+        ss << " }";
+    }
+    ss << "\n  }\n}\n";
+
+    return ss.str();
+}
+
+bool ExportStatistics::writeJSON(const std::string& filename) const
+{
+    std::ofstream ofs(filename.c_str());
+
+    if (!ofs)
+        return false;
+
+    ofs << toJSON();
+    return ofs.good();
+}
+
+double ExportStatistics::secondsSince(const Clock::time_point& start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+ExportStatistics::ScopedPhase::ScopedPhase(ExportStatistics& stats, const char* name)
+  : m_stats(stats)
+  , m_name(name)
+  , m_start(Clock::now())
+{
+    if (Tracer::enabled())
+        Tracer::beginEvent("export", name);
+}
+
+ExportStatistics::ScopedPhase::~ScopedPhase()
+{
+    m_stats.addPhase(m_name, secondsSince(m_start));
+
+    if (Tracer::enabled())
+        Tracer::endEvent("export");
+}
+
+namespace ExportStatisticsReport
+{
+
+size_t currentRSS()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+        return static_cast<size_t>(info.WorkingSetSize);
+
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return 0;
+
+    return static_cast<size_t>(info.resident_size);
+#else
+    // The second field is the number of resident pages.
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == nullptr)
+        return 0;
+
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    const int fields = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+
+    if (fields != 2)
+        return 0;
+
+    return static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+size_t peakRSS()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+        return static_cast<size_t>(info.PeakWorkingSetSize);
+
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#if defined(__APPLE__)
+    // Bytes on macOS.
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // Kilobytes on Linux.
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+bool writeReportsEnabled()
+{
+    const char* value = getenv("APPLESEED_MAYA_EXPORT_STATS");
+    return value != nullptr && strcmp(value, "0") != 0;
+}
+
+void setLastReport(const std::string& report)
+{
+    g_lastReport = report;
+}
+
+const std::string& lastReport()
+{
+    return g_lastReport;
+}
+
+} // ExportStatisticsReport
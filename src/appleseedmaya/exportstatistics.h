@@ -0,0 +1,151 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_EXPORTSTATISTICS_H
+#define APPLESEED_MAYA_EXPORTSTATISTICS_H
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Timings, counters and memory usage collected while exporting a scene.
+//
+
+class ExportStatistics
+  : public foundation::NonCopyable
+{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    ExportStatistics();
+
+    // Record a phase of the export.
+    void addPhase(const std::string& name, const double seconds);
+
+    // Add an extra value to the last recorded phase. A ScopedPhase
+    // records its phase at the end of its scope, call this after it.
+    void addPhaseValue(const char* name, const double value);
+
+    // Accumulate the time spent by an exporter type in a step of the export.
+    void addExporterTime(
+        const std::string&  exporterType,
+        const char*         step,
+        const double        seconds);
+
+    // Count an exporter of the given type.
+    void addExporter(const std::string& exporterType);
+
+    // Thread safe.
+    void addGeometryBytes(const size_t bytes);
+
+    // Record the total time and the memory usage at the end of the export.
+    void finish(const char* sessionName, const std::string& projectName);
+
+    std::string toJSON() const;
+
+    bool writeJSON(const std::string& filename) const;
+
+    static double secondsSince(const Clock::time_point& start);
+
+    //
+    // Measure the time spent in a scope and record it as a phase.
+    //
+
+    class ScopedPhase
+      : public foundation::NonCopyable
+    {
+      public:
+        ScopedPhase(ExportStatistics& stats, const char* name);
+        ~ScopedPhase();
+
+      private:
+        ExportStatistics&   m_stats;
+        const char*         m_name;
+        Clock::time_point   m_start;
+    };
+
+  private:
+    struct Phase
+    {
+        std::string                                 m_name;
+        double                                      m_seconds;
+        std::vector<std::pair<std::string, double>> m_values;
+    };
+
+    struct ExporterTypeStats
+    {
+        ExporterTypeStats();
+
+        size_t                                      m_count;
+        std::map<std::string, double>               m_steps;
+    };
+
+    Clock::time_point                               m_start;
+    double                                          m_totalSeconds;
+    std::string                                     m_sessionName;
+    std::string                                     m_projectName;
+    std::vector<Phase>                              m_phases;
+    std::map<std::string, ExporterTypeStats>        m_exporterTypes;
+    std::atomic<size_t>                             m_geometryBytes;
+    size_t                                          m_startRSS;
+    size_t                                          m_endRSS;
+    size_t                                          m_processPeakRSS;
+};
+
+namespace ExportStatisticsReport
+{
+
+// Return the current resident set size of the process in bytes.
+size_t currentRSS();
+
+// Return the peak resident set size of the process in bytes,
+// over the lifetime of the process.
+size_t peakRSS();
+
+// Return true if the reports have to be written to disk.
+// Enabled with the APPLESEED_MAYA_EXPORT_STATS environment variable.
+bool writeReportsEnabled();
+
+// Last export report, returned by the appleseedExportStats command.
+void setLastReport(const std::string& report);
+const std::string& lastReport();
+
+} // ExportStatisticsReport
+
+#endif  // !APPLESEED_MAYA_EXPORTSTATISTICS_H
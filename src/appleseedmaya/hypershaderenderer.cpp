@@ -29,6 +29,270 @@
 // Interface header.
 #include "hypershaderenderer.h"
 
+// appleseed-maya headers.
+#include "appleseedmaya/appleseedsession.h"
+#include "appleseedmaya/attributeutils.h"
+#include "appleseedmaya/exporters/exporterfactory.h"
+#include "appleseedmaya/exporters/shadingnetworkexporter.h"
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/pixelkernels.h"
+#include "appleseedmaya/tracer.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/camera.h"
+#include "renderer/api/color.h"
+#include "renderer/api/environment.h"
+#include "renderer/api/environmentedf.h"
+#include "renderer/api/environmentshader.h"
+#include "renderer/api/frame.h"
+#include "renderer/api/light.h"
+#include "renderer/api/material.h"
+#include "renderer/api/object.h"
+#include "renderer/api/rendering.h"
+#include "renderer/api/scene.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/canvasproperties.h"
+#include "foundation/image/image.h"
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/math/matrix.h"
+#include "foundation/math/transform.h"
+#include "foundation/math/vector.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MColor.h>
+#include <maya/MFloatArray.h>
+#include <maya/MFnCamera.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnMesh.h>
+#include <maya/MIntArray.h>
+#include <maya/MPlug.h>
+#include <maya/MUuid.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <cassert>
+#include <vector>
+
+namespace asf = foundation;
+namespace asr = renderer;
+
+namespace
+{
+    const size_t TileSize = 32;
+
+    std::string uuidKey(const MUuid& id)
+    {
+        return id.asString().asChar();
+    }
+
+    MString materialName(const std::string& shaderId)
+    {
+        return MString(shaderId.c_str()) + "_material";
+    }
+
+    asf::Matrix4d convert(const MMatrix& m)
+    {
+        asf::Matrix4d result;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            for (int j = 0; j < 4; ++j)
+                result(i, j) = m[j][i];
+        }
+
+        return result;
+    }
+
+    asf::Transformd convertTransform(const MMatrix& m)
+    {
+        return asf::Transformd(convert(m), convert(m.inverse()));
+    }
+
+    // Create an appleseed mesh from a Maya mesh, with a single material slot.
+    asf::auto_release_ptr<asr::MeshObject> createMeshObject(
+        const char*     name,
+        const MObject&  node)
+    {
+        MStatus status;
+        MFnMesh meshFn(node, &status);
+        if (!status)
+            return asf::auto_release_ptr<asr::MeshObject>();
+
+        asf::auto_release_ptr<asr::MeshObject> mesh(
+            asr::MeshObjectFactory().create(name, asr::ParamArray()));
+        mesh->push_material_slot("default");
+
+        const unsigned int numVertices = static_cast<unsigned int>(meshFn.numVertices());
+        const float* p = meshFn.getRawPoints(&status);
+        mesh->reserve_vertices(numVertices);
+        for (unsigned int i = 0; i < numVertices; ++i, p += 3)
+            mesh->push_vertex(asr::GVector3(p[0], p[1], p[2]));
+
+        const asr::GVector3 Y(0.0f, 1.0f, 0.0f);
+        const unsigned int numNormals = static_cast<unsigned int>(meshFn.numNormals());
+        const float* n = meshFn.getRawNormals(&status);
+        mesh->reserve_vertex_normals(numNormals);
+        for (unsigned int i = 0; i < numNormals; ++i, n += 3)
+            mesh->push_vertex_normal(asf::safe_normalize(asr::GVector3(n[0], n[1], n[2]), Y));
+
+        MFloatArray u, v;
+        meshFn.getUVs(u, v);
+        const bool exportUVs = u.length() != 0;
+        mesh->reserve_tex_coords(u.length());
+        for (unsigned int i = 0, e = u.length(); i < e; ++i)
+            mesh->push_tex_coords(asr::GVector2(u[i], v[i]));
+
+        MIntArray faceVertexCounts;
+        MIntArray faceVertexIndices;
+        meshFn.getVertices(faceVertexCounts, faceVertexIndices);
+
+        MIntArray triangleCounts;
+        MIntArray triangleOffsets;
+        meshFn.getTriangleOffsets(triangleCounts, triangleOffsets);
+
+        MIntArray faceNormalCounts;
+        MIntArray faceNormalIndices;
+        meshFn.getNormalIds(faceNormalCounts, faceNormalIndices);
+
+        MIntArray faceUVCounts;
+        MIntArray faceUVIndices;
+        if (exportUVs)
+            meshFn.getAssignedUVs(faceUVCounts, faceUVIndices);
+
+        mesh->reserve_triangles(triangleOffsets.length() / 3);
+
+        unsigned int faceVertexBase = 0;
+        unsigned int faceUVBase = 0;
+        unsigned int triangleCorner = 0;
+
+        for (unsigned int face = 0, numFaces = faceVertexCounts.length(); face < numFaces; ++face)
+        {
+            // Faces without UVs get the first UV.
+            const bool faceHasUVs = exportUVs && faceUVCounts[face] != 0;
+
+            for (int i = 0, e = triangleCounts[face]; i < e; ++i, triangleCorner += 3)
+            {
+                const unsigned int o0 = triangleOffsets[triangleCorner + 0];
+                const unsigned int o1 = triangleOffsets[triangleCorner + 1];
+                const unsigned int o2 = triangleOffsets[triangleCorner + 2];
+
+                asr::Triangle triangle(
+                    faceVertexIndices[o0],
+                    faceVertexIndices[o1],
+                    faceVertexIndices[o2],
+                    0);
+
+                if (exportUVs)
+                {
+                    if (faceHasUVs)
+                    {
+                        triangle.m_a0 = faceUVIndices[faceUVBase + o0 - faceVertexBase];
+                        triangle.m_a1 = faceUVIndices[faceUVBase + o1 - faceVertexBase];
+                        triangle.m_a2 = faceUVIndices[faceUVBase + o2 - faceVertexBase];
+                    }
+                    else
+                        triangle.m_a0 = triangle.m_a1 = triangle.m_a2 = 0;
+                }
+
+                triangle.m_n0 = faceNormalIndices[o0];
+                triangle.m_n1 = faceNormalIndices[o1];
+                triangle.m_n2 = faceNormalIndices[o2];
+
+                mesh->push_triangle(triangle);
+            }
+
+            faceVertexBase += faceVertexCounts[face];
+
+            if (exportUVs)
+                faceUVBase += faceUVCounts[face];
+        }
+
+        return mesh;
+    }
+
+    template <typename Container>
+    void removeEntity(Container& container, const char* name)
+    {
+        if (auto entity = container.get_by_name(name))
+            container.remove(entity);
+    }
+}
+
+//
+// Sends the rendered tiles to Maya.
+//
+
+class HypershadeRenderer::TileCallback
+  : public asr::TileCallbackBase
+{
+  public:
+    explicit TileCallback(HypershadeRenderer& renderer)
+      : m_renderer(renderer)
+    {
+    }
+
+    void release() override
+    {
+        delete this;
+    }
+
+    void on_tile_end(
+        const asr::Frame*   frame,
+        const size_t        tile_x,
+        const size_t        tile_y) override
+    {
+        const asf::CanvasProperties& props = frame->image().properties();
+        m_renderer.refreshTile(
+            frame->image().tile(tile_x, tile_y),
+            tile_x * props.m_tile_width,
+            tile_y * props.m_tile_height,
+            props.m_canvas_height);
+    }
+
+    void on_progressive_frame_update(const asr::Frame* frame) override
+    {
+        const asf::CanvasProperties& props = frame->image().properties();
+
+        for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
+        {
+            for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
+                on_tile_end(frame, tx, ty);
+        }
+    }
+
+  private:
+    HypershadeRenderer& m_renderer;
+};
+
+class HypershadeRenderer::TileCallbackFactory
+  : public asr::ITileCallbackFactory
+{
+  public:
+    explicit TileCallbackFactory(HypershadeRenderer& renderer)
+      : m_renderer(renderer)
+    {
+    }
+
+    void release() override
+    {
+        delete this;
+    }
+
+    asr::ITileCallback* create() override
+    {
+        return new TileCallback(m_renderer);
+    }
+
+  private:
+    HypershadeRenderer& m_renderer;
+};
+
 const MString HypershadeRenderer::name("appleseed");
 
 void* HypershadeRenderer::creator()
@@ -37,41 +301,111 @@ void* HypershadeRenderer::creator()
 }
 
 HypershadeRenderer::HypershadeRenderer()
+  : m_mainAssembly(nullptr)
+  , m_runningAsync(false)
+  , m_inSceneUpdate(false)
+  , m_maxSamples(0)
+  , m_width(128)
+  , m_height(128)
+  , m_frameChanged(false)
+{
+}
+
+HypershadeRenderer::~HypershadeRenderer()
 {
+    destroyScene();
 }
 
 bool HypershadeRenderer::isSafeToUnload()
 {
-    return true;
+    return !m_renderThread.joinable();
 }
 
 MStatus HypershadeRenderer::startAsync(const JobParams& params)
 {
+    if (m_project.get() == nullptr)
+        createProject();
+
+    stopRender();
+
+    if (!m_renderer || params.maxSamples != m_maxSamples)
+    {
+        m_maxSamples = params.maxSamples;
+        createRenderer();
+    }
+
+    m_runningAsync = true;
+
+    // Renders started during scene updates start at the end of the update.
+    if (!m_inSceneUpdate)
+        startRender();
+
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::stopAsync()
 {
+    stopRender();
+    m_runningAsync = false;
     return MS::kSuccess;
 }
 
 bool HypershadeRenderer::isRunningAsync()
 {
-    return true;
+    return m_runningAsync;
 }
 
 MStatus HypershadeRenderer::beginSceneUpdate()
 {
+    if (m_project.get() == nullptr)
+        createProject();
+
+    // Entities can't be edited while rendering.
+    stopRender();
+    m_inSceneUpdate = true;
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::endSceneUpdate()
 {
+    m_inSceneUpdate = false;
+
+    if (m_frameChanged)
+    {
+        updateFrame();
+        createCamera();
+        m_frameChanged = false;
+    }
+
+    for (auto it = m_dirtyInstances.begin(), e = m_dirtyInstances.end(); it != e; ++it)
+        updateMeshInstance(*it);
+
+    m_dirtyInstances.clear();
+
+    if (m_runningAsync)
+        startRender();
+
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::destroyScene()
 {
+    stopRender();
+
+    // Shading network exporters remove their entities from the main assembly.
+    m_shaders.clear();
+    m_meshes.clear();
+    m_lights.clear();
+    m_cameraId.clear();
+    m_cameraNode = MObject();
+    m_matrices.clear();
+    m_dirtyInstances.clear();
+
+    m_renderer.reset();
+    m_tileCallbackFactory.reset();
+    m_mainAssembly = nullptr;
+    m_project.reset();
+
     return MS::kSuccess;
 }
 
@@ -97,41 +431,439 @@ MStatus HypershadeRenderer::setProperty(const MUuid& id, const MString& name, co
 
 MStatus HypershadeRenderer::setShader(const MUuid& id, const MUuid& shaderId)
 {
+    const std::string key = uuidKey(id);
+
+    m_meshes[key].m_shaderId = uuidKey(shaderId);
+    m_dirtyInstances.insert(key);
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::setResolution(unsigned int w, unsigned int h)
 {
+    if (w != m_width || h != m_height)
+    {
+        m_width = w;
+        m_height = h;
+        m_frameChanged = true;
+    }
+
     return MS::kSuccess;
 }
 
-
 MStatus HypershadeRenderer::translateMesh(const MUuid& id, const MObject& node)
 {
+    if (m_project.get() == nullptr)
+        return MS::kFailure;
+
+    const std::string key = uuidKey(id);
+
+    asf::auto_release_ptr<asr::MeshObject> mesh = createMeshObject(key.c_str(), node);
+    if (mesh.get() == nullptr)
+        return MS::kFailure;
+
+    removeEntity(m_mainAssembly->objects(), key.c_str());
+    m_mainAssembly->objects().insert(asf::auto_release_ptr<asr::Object>(mesh.release()));
+
+    m_meshes.emplace(key, MeshEntry());
+    m_dirtyInstances.insert(key);
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::translateLightSource(const MUuid& id, const MObject& node)
 {
+    if (m_project.get() == nullptr)
+        return MS::kFailure;
+
+    const std::string key = uuidKey(id);
+    const MString colorName = MString(key.c_str()) + "_color";
+
+    removeEntity(m_mainAssembly->lights(), key.c_str());
+    removeEntity(m_mainAssembly->colors(), colorName.asChar());
+
+    float intensity = 1.0f;
+    AttributeUtils::get(node, "intensity", intensity);
+
+    MColor color(1.0f, 1.0f, 1.0f);
+    AttributeUtils::get(node, "color", color);
+
+    asr::ParamArray colorParams;
+    colorParams.insert("color_space", "linear_rgb");
+    m_mainAssembly->colors().insert(
+        asr::ColorEntityFactory::create(
+            colorName.asChar(),
+            colorParams,
+            asr::ColorValueArray(3, &color.r)));
+
+    // Other light types are previewed as point lights.
+    asf::auto_release_ptr<asr::Light> light;
+    if (node.hasFn(MFn::kDirectionalLight))
+    {
+        light = asr::DirectionalLightFactory().create(
+            key.c_str(),
+            asr::ParamArray()
+                .insert("irradiance", colorName.asChar())
+                .insert("irradiance_multiplier", intensity));
+    }
+    else
+    {
+        light = asr::PointLightFactory().create(
+            key.c_str(),
+            asr::ParamArray()
+                .insert("intensity", colorName.asChar())
+                .insert("intensity_multiplier", intensity));
+    }
+
+    m_mainAssembly->lights().insert(light);
+    m_lights.insert(key);
+    updateTransform(key);
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::translateCamera(const MUuid& id, const MObject& node)
 {
+    if (m_project.get() == nullptr)
+        return MS::kFailure;
+
+    m_cameraId = uuidKey(id);
+    m_cameraNode = node;
+    createCamera();
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::translateEnvironment(const MUuid& id, EnvironmentType type)
 {
+    // The preview scene keeps its constant environment.
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::translateTransform(const MUuid& id, const MUuid& childId, const MMatrix& matrix)
 {
+    if (m_project.get() == nullptr)
+        return MS::kFailure;
+
+    const std::string key = uuidKey(childId);
+    m_matrices[key] = matrix;
+    updateTransform(key);
     return MS::kSuccess;
 }
 
 MStatus HypershadeRenderer::translateShader(const MUuid& id, const MObject& node)
 {
+    if (m_project.get() == nullptr)
+        return MS::kFailure;
+
+    MStatus status;
+    MObject shaderNode = node;
+
+    // Shading engines are previewed with their surface shader.
+    if (node.hasFn(MFn::kShadingEngine))
+    {
+        MPlug srcPlug;
+        status = AttributeUtils::getPlugConnectedTo(
+            MFnDependencyNode(node).findPlug("surfaceShader", false),
+            srcPlug);
+        if (!status)
+            return status;
+
+        shaderNode = srcPlug.node();
+    }
+
+    MFnDependencyNode depNodeFn(shaderNode);
+    MPlug outputPlug = depNodeFn.findPlug("outColor", false, &status);
+    if (!status)
+        return status;
+
+    const std::string key = uuidKey(id);
+    ShaderEntry& shader = m_shaders[key];
+
+    if (shader.m_network && shader.m_node == shaderNode)
+    {
+        // Parameter edits only export the shading network again,
+        // the rest of the preview scene is kept.
+        shader.m_network->removeEntities();
+    }
+    else
+    {
+        shader.m_node = shaderNode;
+        shader.m_network.reset();
+        shader.m_network.reset(
+            NodeExporterFactory::createShadingNetworkExporter(
+                SurfaceSwatchNetworkContext,
+                shaderNode,
+                outputPlug,
+                *m_mainAssembly,
+                AppleseedSession::ProgressiveRenderSession));
+    }
+
+    shader.m_network->createEntities();
+    shader.m_network->flushEntities();
+
+    const MString shaderGroupName = shader.m_network->shaderGroupName();
+
+    asr::Material* material = m_mainAssembly->materials().get_by_name(materialName(key).asChar());
+    if (material)
+    {
+        material->get_parameters().insert("osl_surface", shaderGroupName.asChar());
+        material->bump_version_id();
+    }
+    else
+    {
+        m_mainAssembly->materials().insert(
+            asr::OSLMaterialFactory().create(
+                materialName(key).asChar(),
+                asr::ParamArray().insert("osl_surface", shaderGroupName.asChar())));
+    }
+
+    RENDERER_LOG_DEBUG("Translated hypershade shader %s", depNodeFn.name().asChar());
     return MS::kSuccess;
 }
+
+void HypershadeRenderer::createProject()
+{
+    assert(m_project.get() == nullptr);
+
+    // Disable logging from appleseed.
+    ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
+
+    m_project = asr::ProjectFactory::create("hypershade");
+    m_project->add_default_configurations();
+
+    // Insert some config params needed by the interactive renderer.
+    asr::ParamArray& cfgParams = m_project->configurations().get_by_name("interactive")->get_parameters();
+    cfgParams.insert("spectrum_mode", "rgb");
+    cfgParams.insert("sample_renderer", "generic");
+    cfgParams.insert("sample_generator", "generic");
+    cfgParams.insert("frame_renderer", "progressive");
+    cfgParams.insert("lighting_engine", "pt");
+    cfgParams.insert("sampling_mode", "qmc");
+    cfgParams.insert_path("progressive_frame_renderer.max_fps", "10");
+
+    // Create the scene.
+    asf::auto_release_ptr<asr::Scene> scene = asr::SceneFactory::create();
+    m_project->set_scene(scene);
+
+    // Create a default camera, replaced by the translated camera.
+    asf::auto_release_ptr<asr::Camera> camera = asr::PinholeCameraFactory().create(
+        "camera",
+        asr::ParamArray()
+            .insert("film_dimensions", "0.0359999 0.0359999")
+            .insert("focal_length", "0.035"));
+    camera->transform_sequence().set_transform(
+        0.0f,
+        asf::Transformd(asf::Matrix4d::make_translation(asf::Vector3d(0.0, 0.0, 2.65))));
+    m_project->get_scene()->cameras().insert(camera);
+
+    // Create the environment.
+    asf::auto_release_ptr<asr::EnvironmentEDF> environmentEDF(asr::ConstantEnvironmentEDFFactory().create(
+        "environmentEDF",
+        asr::ParamArray().insert("radiance", "0.025")));
+    m_project->get_scene()->environment_edfs().insert(environmentEDF);
+
+    asf::auto_release_ptr<asr::EnvironmentShader> environmentShader(asr::EDFEnvironmentShaderFactory().create(
+        "environmentShader",
+        asr::ParamArray()
+            .insert("environment_edf", "environmentEDF")
+            .insert("alpha_value", "1.0")));
+    m_project->get_scene()->environment_shaders().insert(environmentShader);
+
+    asf::auto_release_ptr<asr::Environment> environment = asr::EnvironmentFactory().create(
+        "environment",
+        asr::ParamArray().insert("environment_shader", "environmentShader"));
+    m_project->get_scene()->set_environment(environment);
+
+    // Create the frame.
+    updateFrame();
+
+    // Create the main assembly.
+    asf::auto_release_ptr<asr::Assembly> assembly = asr::AssemblyFactory().create("assembly", asr::ParamArray());
+    m_mainAssembly = assembly.get();
+    m_project->get_scene()->assemblies().insert(assembly);
+
+    // Instance the main assembly.
+    asf::auto_release_ptr<asr::AssemblyInstance> assemblyInstance = asr::AssemblyInstanceFactory::create(
+        "assembly_inst",
+        asr::ParamArray(),
+        "assembly");
+    m_project->get_scene()->assembly_instances().insert(assemblyInstance);
+
+    m_tileCallbackFactory.reset(new TileCallbackFactory(*this));
+
+    RENDERER_LOG_DEBUG("Created hypershade render project");
+}
+
+void HypershadeRenderer::createRenderer()
+{
+    assert(!m_renderThread.joinable());
+
+    asr::Configuration* cfg = m_project->configurations().get_by_name("interactive");
+
+    if (m_maxSamples != 0)
+        cfg->get_parameters().insert_path("progressive_frame_renderer.max_average_spp", m_maxSamples);
+    else
+        cfg->get_parameters().remove_path("progressive_frame_renderer.max_average_spp");
+
+    m_renderer.reset(
+        new asr::MasterRenderer(
+            *m_project,
+            cfg->get_inherited_parameters(),
+            m_resourceSearchPaths,
+            m_tileCallbackFactory.get()));
+}
+
+void HypershadeRenderer::stopRender()
+{
+    if (!m_renderThread.joinable())
+        return;
+
+    m_rendererController.set_status(asr::IRendererController::AbortRendering);
+    m_renderThread.join();
+}
+
+void HypershadeRenderer::startRender()
+{
+    assert(m_renderer);
+    assert(!m_renderThread.joinable());
+
+    m_rendererController.set_status(asr::IRendererController::ContinueRendering);
+
+    std::thread thread(&HypershadeRenderer::renderFunc, this);
+    m_renderThread.swap(thread);
+}
+
+void HypershadeRenderer::renderFunc()
+{
+    Tracer::setThreadName("Hypershade render thread");
+    Tracer::ScopedEvent event("render", "hypershadeRender");
+
+    m_renderer->render(m_rendererController);
+}
+
+void HypershadeRenderer::createCamera()
+{
+    MStatus status;
+    MFnCamera cameraFn(m_cameraNode, &status);
+    if (!status)
+        return;
+
+    // Fit the film horizontally to the preview image.
+    const double horizontalFilmAperture = cameraFn.horizontalFilmAperture() * 0.0254;
+    const double imageAspect = static_cast<double>(m_width) / m_height;
+
+    asr::ParamArray cameraParams;
+    cameraParams.insert(
+        "film_dimensions",
+        asf::Vector2d(horizontalFilmAperture, horizontalFilmAperture / imageAspect));
+    cameraParams.insert("focal_length", cameraFn.focalLength() * 0.001);
+
+    removeEntity(m_project->get_scene()->cameras(), "camera");
+    m_project->get_scene()->cameras().insert(
+        asr::PinholeCameraFactory().create("camera", cameraParams));
+
+    updateTransform(m_cameraId);
+}
+
+void HypershadeRenderer::updateFrame()
+{
+    asf::auto_release_ptr<asr::Frame> frame(
+        asr::FrameFactory::create(
+            "beauty",
+            asr::ParamArray()
+                .insert("resolution", asf::Vector2u(m_width, m_height))
+                .insert("camera", "camera")
+                .insert("tile_size", asf::Vector2i(TileSize, TileSize))));
+    m_project->set_frame(frame);
+}
+
+void HypershadeRenderer::updateMeshInstance(const std::string& id)
+{
+    const MString instanceName = MString(id.c_str()) + "_instance";
+    removeEntity(m_mainAssembly->object_instances(), instanceName.asChar());
+
+    if (m_mainAssembly->objects().get_by_name(id.c_str()) == nullptr)
+        return;
+
+    asf::StringDictionary materials;
+    const std::string& shaderId = m_meshes[id].m_shaderId;
+    if (m_shaders.count(shaderId) != 0)
+        materials.insert("default", materialName(shaderId).asChar());
+
+    auto matrixIt = m_matrices.find(id);
+
+    asf::auto_release_ptr<asr::ObjectInstance> objInstance = asr::ObjectInstanceFactory().create(
+        instanceName.asChar(),
+        asr::ParamArray(),
+        id.c_str(),
+        matrixIt != m_matrices.end()
+            ? convertTransform(matrixIt->second)
+            : asf::Transformd::make_identity(),
+        materials,
+        materials);
+    m_mainAssembly->object_instances().insert(objInstance);
+}
+
+void HypershadeRenderer::updateTransform(const std::string& id)
+{
+    auto matrixIt = m_matrices.find(id);
+    if (matrixIt == m_matrices.end())
+        return;
+
+    const asf::Transformd xform = convertTransform(matrixIt->second);
+
+    if (m_meshes.count(id) != 0)
+    {
+        // Object instance transforms are set on creation.
+        m_dirtyInstances.insert(id);
+    }
+    else if (m_lights.count(id) != 0)
+    {
+        if (asr::Light* light = m_mainAssembly->lights().get_by_name(id.c_str()))
+        {
+            light->set_transform(xform);
+            light->bump_version_id();
+        }
+    }
+    else if (id == m_cameraId)
+    {
+        if (asr::Camera* camera = m_project->get_scene()->cameras().get_by_name("camera"))
+        {
+            camera->transform_sequence().clear();
+            camera->transform_sequence().set_transform(0.0f, xform);
+            camera->bump_version_id();
+        }
+    }
+}
+
+void HypershadeRenderer::refreshTile(
+    const asf::Tile&    tile,
+    const size_t        x0,
+    const size_t        y0,
+    const size_t        frameHeight)
+{
+    assert(tile.get_pixel_format() == asf::PixelFormatFloat);
+    assert(tile.get_channel_count() == 4);
+
+    const size_t width = tile.get_width();
+    const size_t height = tile.get_height();
+
+    // Maya's images are y up.
+    std::vector<float> pixels(width * height * 4);
+    PixelKernels::copyRGBAFloatFlipped(
+        reinterpret_cast<const float*>(tile.get_storage()),
+        width * 4,
+        pixels.data(),
+        width * 4,
+        width,
+        height);
+
+    RefreshParams params;
+    params.width = static_cast<unsigned int>(width);
+    params.height = static_cast<unsigned int>(height);
+    params.left = static_cast<unsigned int>(x0);
+    params.right = static_cast<unsigned int>(x0 + width - 1);
+    params.bottom = static_cast<unsigned int>(frameHeight - y0 - height);
+    params.top = static_cast<unsigned int>(frameHeight - 1 - y0);
+    params.channels = 4;
+    params.bytesPerChannel = sizeof(float);
+    params.data = pixels.data();
+    refresh(params);
+}
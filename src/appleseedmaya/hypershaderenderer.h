@@ -29,11 +29,51 @@
 #ifndef APPLESEED_MAYA_HYPERSHADERENDERER_H
 #define APPLESEED_MAYA_HYPERSHADERENDERER_H
 
+// appleseed-maya headers.
+#include "appleseedmaya/exporters/shadingnetworkexporterfwd.h"
+#include "appleseedmaya/renderercontroller.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/project.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/autoreleaseptr.h"
+#include "foundation/utility/searchpaths.h"
+
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MMatrix.h>
+#include <maya/MObject.h>
 #include <maya/MPxRenderer.h>
+#include <maya/MString.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
+// Standard headers.
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+
+// Forward declarations.
+namespace foundation    { class Tile; }
+namespace renderer      { class Assembly; }
+namespace renderer      { class MasterRenderer; }
+
+//
+// Material preview renderer for Hypershade and the material viewer.
+//
+// Maya translates the preview scene between beginSceneUpdate and endSceneUpdate.
+// The entities are kept in a persistent appleseed project, indexed by the MUuid of
+// the translated objects, so that later scene updates only edit the entities that
+// changed. startAsync starts a progressive render in a background thread, which is
+// stopped during scene updates and restarted after them.
+//
+
 class HypershadeRenderer
   : public MPxRenderer
 {
@@ -44,6 +84,8 @@ class HypershadeRenderer
 
     HypershadeRenderer();
 
+    ~HypershadeRenderer() override;
+
     bool isSafeToUnload() override;
 
     MStatus startAsync(const JobParams& params) override;
@@ -68,6 +110,62 @@ class HypershadeRenderer
     MStatus translateEnvironment(const MUuid& id, EnvironmentType type) override;
     MStatus translateTransform(const MUuid& id, const MUuid& childId, const MMatrix& matrix) override;
     MStatus translateShader(const MUuid& id, const MObject& node) override;
+
+  private:
+    class TileCallback;
+    class TileCallbackFactory;
+
+    struct MeshEntry
+    {
+        std::string                 m_shaderId;
+    };
+
+    struct ShaderEntry
+    {
+        MObject                     m_node;
+        ShadingNetworkExporterPtr   m_network;
+    };
+
+    void createProject();
+    void createRenderer();
+    void stopRender();
+    void startRender();
+    void renderFunc();
+
+    void createCamera();
+    void updateFrame();
+    void updateMeshInstance(const std::string& id);
+    void updateTransform(const std::string& id);
+
+    // Send a rendered tile to Maya. Called from the render threads.
+    void refreshTile(
+        const foundation::Tile&     tile,
+        const size_t                x0,
+        const size_t                y0,
+        const size_t                frameHeight);
+
+    foundation::SearchPaths                         m_resourceSearchPaths;
+    foundation::auto_release_ptr<renderer::Project> m_project;
+    renderer::Assembly*                             m_mainAssembly;
+    std::unique_ptr<TileCallbackFactory>            m_tileCallbackFactory;
+    std::unique_ptr<renderer::MasterRenderer>       m_renderer;
+    RendererController                              m_rendererController;
+    std::thread                                     m_renderThread;
+    bool                                            m_runningAsync;
+    bool                                            m_inSceneUpdate;
+    unsigned int                                    m_maxSamples;
+    unsigned int                                    m_width;
+    unsigned int                                    m_height;
+    bool                                            m_frameChanged;
+
+    // Translated entities, indexed by MUuid.
+    std::map<std::string, MeshEntry>                m_meshes;
+    std::map<std::string, ShaderEntry>              m_shaders;
+    std::set<std::string>                           m_lights;
+    std::string                                     m_cameraId;
+    MObject                                         m_cameraNode;
+    std::map<std::string, MMatrix>                  m_matrices;
+    std::set<std::string>                           m_dirtyInstances;
 };
 
 #endif  // !APPLESEED_MAYA_HYPERSHADERENDERER_H
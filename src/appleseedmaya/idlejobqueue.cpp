@@ -31,6 +31,10 @@
 
 // appleseed-maya headers.
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/tracer.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
 
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
@@ -40,36 +44,120 @@
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <mutex>
-#include <queue>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+namespace asf = foundation;
 
 namespace
 {
+    typedef std::chrono::steady_clock Clock;
+
+    // Number of job slots. Must be a power of two.
+    const size_t SlotCount = 1024;
+
+    // Slot of the bounded multi-producer / single-consumer queue.
+    // A slot is free for the producer pushing at position pos when its sequence is pos,
+    // and holds a job ready for the consumer when its sequence is pos + 1.
+    struct alignas(64) Slot
+    {
+        // Storage has to be the first member, see slotFromStorage().
+        alignas(std::max_align_t) unsigned char     m_storage[IdleJobQueue::MaxJobSize];
+        std::atomic<size_t>                         m_sequence;
+        IdleJobQueue::Detail::RunJobFun             m_runJob;
+        Clock::time_point                           m_pushTime;
+    };
+
+    Slot g_slots[SlotCount];
+    std::atomic<size_t> g_pushPosition(0);
+    size_t g_popPosition = 0;
+
     MCallbackId g_callbackId;
+    std::thread::id g_mainThreadId;
+    double g_timeBudget = 0.008;
 
-    std::queue<std::function<void ()>> g_jobQueue;
-    std::mutex g_jobQueueMutex;
+    // Counters.
+    std::atomic<size_t> g_queueDepth(0);
+    std::atomic<size_t> g_maxQueueDepth(0);
+    size_t g_executedJobs = 0;
+    size_t g_budgetExceeded = 0;
+    std::atomic<size_t> g_droppedJobs(0);
+    double g_totalLatency = 0.0;
+    double g_maxLatency = 0.0;
 
-    static void idleCallback(void* clientData)
+    Slot& slotFromStorage(void* storage)
     {
-        while (true)
+        return *reinterpret_cast<Slot*>(storage);
+    }
+
+    double secondsSince(const Clock::time_point& start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Execute the pending jobs in the main thread.
+    // Stop after timeBudget seconds if timeBudget is positive.
+    // Jobs pushed by the executed jobs are left for the next call.
+    void executeJobs(const double timeBudget)
+    {
+        const Clock::time_point start = Clock::now();
+        const size_t endPosition = g_pushPosition.load(std::memory_order_relaxed);
+        size_t executedJobs = 0;
+
+        while (g_popPosition != endPosition)
         {
-            std::function<void ()> job;
+            Slot& slot = g_slots[g_popPosition & (SlotCount - 1)];
+            const size_t position = g_popPosition;
 
+            // Stop if the next job was not pushed yet.
+            if (slot.m_sequence.load(std::memory_order_acquire) != position + 1)
+                break;
+
+            // Leave the remaining jobs for the next idle event.
+            if (timeBudget > 0.0 && executedJobs > 0 && secondsSince(start) > timeBudget)
             {
-                std::lock_guard<std::mutex> lock(g_jobQueueMutex);
+                ++g_budgetExceeded;
+                break;
+            }
 
-                if (g_jobQueue.empty())
-                    break;
+            ++g_popPosition;
+            --g_queueDepth;
 
-                job = std::move(g_jobQueue.front());
-                g_jobQueue.pop();
+            const double latency = secondsSince(slot.m_pushTime);
+            g_totalLatency += latency;
+            g_maxLatency = std::max(g_maxLatency, latency);
+
+            {
+                Tracer::ScopedEvent event("idle", "idleJob");
+                slot.m_runJob(slot.m_storage);
             }
 
-            job();
+            ++g_executedJobs;
+            ++executedJobs;
+
+            // Make the slot available to the producers again.
+            slot.m_sequence.store(position + SlotCount, std::memory_order_release);
         }
     }
+
+    static void idleCallback(void* clientData)
+    {
+        executeJobs(g_timeBudget);
+    }
+
+    void resetStatistics()
+    {
+        g_maxQueueDepth = g_queueDepth.load();
+        g_executedJobs = 0;
+        g_budgetExceeded = 0;
+        g_droppedJobs = 0;
+        g_totalLatency = 0.0;
+        g_maxLatency = 0.0;
+    }
 }
 
 namespace IdleJobQueue
@@ -78,6 +166,23 @@ namespace IdleJobQueue
 MStatus initialize()
 {
     g_callbackId = 0;
+    g_mainThreadId = std::this_thread::get_id();
+
+    for (size_t i = 0; i < SlotCount; ++i)
+        g_slots[i].m_sequence = i;
+
+    g_pushPosition = 0;
+    g_popPosition = 0;
+    g_queueDepth = 0;
+    resetStatistics();
+
+    if (const char* budget = getenv("APPLESEED_MAYA_IDLE_TIME_BUDGET"))
+    {
+        const double ms = atof(budget);
+        if (ms > 0.0)
+            g_timeBudget = ms / 1000.0;
+    }
+
     RENDERER_LOG_INFO("Initialized idle job queue");
     return MS::kSuccess;
 }
@@ -95,6 +200,8 @@ void start()
     {
         RENDERER_LOG_DEBUG("Started idle job queue");
 
+        resetStatistics();
+
         MStatus status;
         g_callbackId = MEventMessage::addEventCallback(
             "idle",
@@ -114,18 +221,91 @@ void stop()
         g_callbackId = 0;
 
         // Perform any pending jobs.
-        idleCallback(nullptr);
-        assert(g_jobQueue.empty());
+        executeJobs(0.0);
+        assert(g_queueDepth == 0);
+
+        const Statistics stats = statistics();
+        RENDERER_LOG_DEBUG(
+            "Idle job queue: %s jobs executed, max queue depth %s, "
+            "average latency %.1f ms, max latency %.1f ms, time budget exceeded %s times, "
+            "%s jobs dropped",
+            asf::pretty_uint(stats.m_executedJobs).c_str(),
+            asf::pretty_uint(stats.m_maxQueueDepth).c_str(),
+            stats.m_averageLatency * 1000.0,
+            stats.m_maxLatency * 1000.0,
+            asf::pretty_uint(stats.m_budgetExceeded).c_str(),
+            asf::pretty_uint(stats.m_droppedJobs).c_str());
     }
 }
 
-void pushJob(std::function<void ()> job)
+Statistics statistics()
+{
+    Statistics stats;
+    stats.m_queueDepth = g_queueDepth;
+    stats.m_maxQueueDepth = g_maxQueueDepth;
+    stats.m_executedJobs = g_executedJobs;
+    stats.m_budgetExceeded = g_budgetExceeded;
+    stats.m_droppedJobs = g_droppedJobs;
+    stats.m_averageLatency = g_executedJobs != 0 ? g_totalLatency / g_executedJobs : 0.0;
+    stats.m_maxLatency = g_maxLatency;
+    return stats;
+}
+
+namespace Detail
+{
+
+void* reserveSlot()
 {
-    assert(job);
     assert(g_callbackId != 0);
 
-    std::lock_guard<std::mutex> lock(g_jobQueueMutex);
-    g_jobQueue.push(std::move(job));
+    size_t position = g_pushPosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Slot& slot = g_slots[position & (SlotCount - 1)];
+        const size_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+
+        if (sequence == position)
+        {
+            if (g_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                return slot.m_storage;
+        }
+        else if (sequence < position)
+        {
+            // The queue is full. The main thread makes room itself, other
+            // threads give up instead of waiting for the next idle event,
+            // which never comes while the main thread is joining them.
+            if (std::this_thread::get_id() != g_mainThreadId)
+            {
+                ++g_droppedJobs;
+                return nullptr;
+            }
+
+            executeJobs(0.0);
+
+            position = g_pushPosition.load(std::memory_order_relaxed);
+        }
+        else
+            position = g_pushPosition.load(std::memory_order_relaxed);
+    }
 }
 
+void publishSlot(void* storage, RunJobFun runJob)
+{
+    Slot& slot = slotFromStorage(storage);
+    slot.m_runJob = runJob;
+    slot.m_pushTime = Clock::now();
+
+    const size_t depth = ++g_queueDepth;
+    size_t maxDepth = g_maxQueueDepth.load(std::memory_order_relaxed);
+    while (depth > maxDepth && !g_maxQueueDepth.compare_exchange_weak(maxDepth, depth))
+        ;
+
+    slot.m_sequence.store(
+        slot.m_sequence.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
+}
+
+} // Detail
+
 } // IdleJobQueue
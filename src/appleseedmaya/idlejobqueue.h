@@ -35,11 +35,27 @@
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
-#include <functional>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//
+// Queue of jobs executed in the main thread during Maya's idle events.
+//
+// Jobs can be pushed from any thread. They are stored in preallocated slots
+// of a lock-free queue, so pushing a job does not allocate memory.
+// Each idle event executes jobs until a time budget is spent, 8 ms by default,
+// and the remaining jobs are executed in the next idle events. The budget can be
+// set in milliseconds with the APPLESEED_MAYA_IDLE_TIME_BUDGET environment variable.
+//
 
 namespace IdleJobQueue
 {
 
+// Maximum size in bytes of a job.
+const size_t MaxJobSize = 96;
+
 MStatus initialize();
 MStatus uninitialize();
 
@@ -50,7 +66,76 @@ void start();
 void stop();
 
 // Push a job to be executed in the main thread during the idle callback.
-void pushJob(std::function<void()> job);
+// When the queue is full, the main thread makes room by executing the pending
+// jobs itself, other threads get false back and the job is dropped: they can't
+// wait for the main thread, which may be waiting for them.
+template <typename Job>
+bool pushJob(Job job);
+
+struct Statistics
+{
+    size_t  m_queueDepth;           // number of jobs waiting to be executed
+    size_t  m_maxQueueDepth;        // maximum number of jobs waiting since the queue was started
+    size_t  m_executedJobs;         // number of jobs executed since the queue was started
+    size_t  m_budgetExceeded;       // number of idle events that ran out of time
+    size_t  m_droppedJobs;          // number of jobs not pushed because the queue was full
+    double  m_averageLatency;       // average time in seconds between pushing and executing a job
+    double  m_maxLatency;           // maximum time in seconds between pushing and executing a job
+};
+
+// Return the counters of the queue.
+Statistics statistics();
+
+
+//
+// Implementation.
+//
+
+namespace Detail
+{
+    // Execute a job stored in a slot and destroy it.
+    typedef void (*RunJobFun)(void* storage);
+
+    template <typename Job>
+    void runJob(void* storage)
+    {
+        struct DestroyJob
+        {
+            Job& m_job;
+
+            ~DestroyJob()
+            {
+                m_job.~Job();
+            }
+        };
+
+        Job& job = *static_cast<Job*>(storage);
+        DestroyJob destroy = {job};
+        job();
+    }
+
+    // Reserve a slot for a job and return its storage.
+    // Return nullptr if the queue is full, except in the main thread.
+    void* reserveSlot();
+
+    // Make a job constructed in a reserved slot visible to the main thread.
+    void publishSlot(void* storage, RunJobFun runJob);
+}
+
+template <typename Job>
+bool pushJob(Job job)
+{
+    static_assert(sizeof(Job) <= MaxJobSize, "Job is too large for the idle job queue");
+    static_assert(std::alignment_of<Job>::value <= std::alignment_of<std::max_align_t>::value, "Unsupported job alignment");
+
+    void* storage = Detail::reserveSlot();
+    if (storage == nullptr)
+        return false;
+
+    new (storage) Job(std::move(job));
+    Detail::publishSlot(storage, &Detail::runJob<Job>);
+    return true;
+}
 
 } // IdleJobQueue
 
@@ -38,6 +38,9 @@
 // appleseed.foundation headers.
 #include "foundation/utility/containers/dictionary.h"
 
+// Standard headers.
+#include <algorithm>
+
 namespace asf = foundation;
 namespace asr = renderer;
 
@@ -57,32 +60,98 @@ uint64_t fmix(uint64_t k)
     return k;
 }
 
+namespace
+{
+
+const uint64_t c1 = 0x87c37b91114253d5;
+const uint64_t c2 = 0x4cf5ad432745937f;
+
+}
+
 MurmurHash::MurmurHash()
   : m_h1(0)
   , m_h2(0)
+  , m_tailSize(0)
+  , m_length(0)
+  , m_finalized(false)
+  , m_f1(0)
+  , m_f2(0)
 {
 }
 
 MurmurHash::MurmurHash(const MurmurHash& other)
   : m_h1(other.m_h1)
   , m_h2(other.m_h2)
+  , m_tailSize(other.m_tailSize)
+  , m_length(other.m_length)
+  , m_finalized(other.m_finalized)
+  , m_f1(other.m_f1)
+  , m_f2(other.m_f2)
 {
+    memcpy(m_tail, other.m_tail, m_tailSize);
 }
 
 const MurmurHash& MurmurHash::operator=(const MurmurHash& other)
 {
     m_h1 = other.m_h1;
     m_h2 = other.m_h2;
+    memcpy(m_tail, other.m_tail, other.m_tailSize);
+    m_tailSize = other.m_tailSize;
+    m_length = other.m_length;
+    m_finalized = other.m_finalized;
+    m_f1 = other.m_f1;
+    m_f2 = other.m_f2;
     return *this;
 }
 
 void MurmurHash::append(const void* data, size_t bytes)
 {
-    const int nBlocks = static_cast<int>(bytes) / 16;
+    if (bytes == 0)
+        return;
+
+    m_finalized = false;
+    m_length += bytes;
+
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    // Complete the pending partial block first.
+    if (m_tailSize != 0)
+    {
+        const size_t n = std::min(bytes, 16 - m_tailSize);
+        memcpy(m_tail + m_tailSize, p, n);
+        m_tailSize += n;
+        p += n;
+        bytes -= n;
+
+        if (m_tailSize < 16)
+            return;
+
+        processBlocks(m_tail, 1);
+        m_tailSize = 0;
+    }
+
+    // Process all the full blocks directly from the input.
+    const size_t nBlocks = bytes / 16;
+    processBlocks(p, nBlocks);
+    p += nBlocks * 16;
+    bytes -= nBlocks * 16;
 
-    const uint64_t c1 = 0x87c37b91114253d5;
-    const uint64_t c2 = 0x4cf5ad432745937f;
+    // Keep the remaining bytes for later.
+    memcpy(m_tail, p, bytes);
+    m_tailSize = bytes;
+}
+
+void MurmurHash::appendString(const char* str, size_t length)
+{
+    // Prefix strings with their length, so that consecutive
+    // strings can't be confused with one another ("ab" + "c" vs "a" + "bc").
+    const uint64_t len = length;
+    append(&len, sizeof(uint64_t));
+    append(static_cast<const void*>(str), length);
+}
 
+void MurmurHash::processBlocks(const uint8_t* data, size_t nBlocks)
+{
     // local copies of m_h1, and m_h2. we'll work
     // with these before copying back at the end.
     // this gives the optimiser more freedom to do
@@ -90,13 +159,12 @@ void MurmurHash::append(const void* data, size_t bytes)
     uint64_t h1 = m_h1;
     uint64_t h2 = m_h2;
 
-    // body
-
-    const uint64_t* blocks = (const uint64_t *)data;
-    for (int i = 0; i < nBlocks; i++)
+    for (size_t i = 0; i < nBlocks; ++i, data += 16)
     {
-        uint64_t k1 = blocks[i*2];
-        uint64_t k2 = blocks[i*2+1];
+        uint64_t k1;
+        uint64_t k2;
+        memcpy(&k1, data, sizeof(uint64_t));
+        memcpy(&k2, data + 8, sizeof(uint64_t));
 
         k1 *= c1; k1  = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
 
@@ -107,14 +175,26 @@ void MurmurHash::append(const void* data, size_t bytes)
         h2 = rotl64(h2, 31); h2 += h1; h2 = h2*5 + 0x38495ab5;
     }
 
+    m_h1 = h1;
+    m_h2 = h2;
+}
+
+void MurmurHash::finalize() const
+{
+    if (m_finalized)
+        return;
+
+    uint64_t h1 = m_h1;
+    uint64_t h2 = m_h2;
+
     // tail
 
-    const uint8_t * tail = ((const uint8_t*)data) + nBlocks*16;
+    const uint8_t* tail = m_tail;
 
     uint64_t k1 = 0;
     uint64_t k2 = 0;
 
-    switch(bytes & 15)
+    switch(m_tailSize)
     {
     case 15: k2 ^= uint64_t(tail[14]) << 48;
     case 14: k2 ^= uint64_t(tail[13]) << 40;
@@ -138,7 +218,7 @@ void MurmurHash::append(const void* data, size_t bytes)
 
     // finalisation
 
-    h1 ^= bytes; h2 ^= bytes;
+    h1 ^= m_length; h2 ^= m_length;
 
     h1 += h2;
     h2 += h1;
@@ -149,34 +229,48 @@ void MurmurHash::append(const void* data, size_t bytes)
     h1 += h2;
     h2 += h1;
 
-    m_h1 = h1;
-    m_h2 = h2;
+    m_f1 = h1;
+    m_f2 = h2;
+    m_finalized = true;
 }
 
 bool MurmurHash::operator==(const MurmurHash& other) const
 {
-    return m_h1 == other.m_h1 && m_h2 == other.m_h2;
+    finalize();
+    other.finalize();
+    return m_f1 == other.m_f1 && m_f2 == other.m_f2;
 }
 
 bool MurmurHash::operator!=(const MurmurHash& other) const
 {
-    return m_h1 != other.m_h1 || m_h2 != other.m_h2;
+    return !(*this == other);
 }
 
 bool MurmurHash::operator<(const MurmurHash& other) const
 {
-    return m_h1 < other.m_h1 ||(m_h1 == other.m_h1 && m_h2 < other.m_h2);
+    finalize();
+    other.finalize();
+    return m_f1 < other.m_f1 ||(m_f1 == other.m_f1 && m_f2 < other.m_f2);
 }
 
 std::string MurmurHash::toString() const
 {
+    finalize();
+
     std::stringstream s;
     s << std::hex << std::setfill('0')
-      << std::setw(16) << m_h1
-      << std::setw(16) << m_h2;
+      << std::setw(16) << m_f1
+      << std::setw(16) << m_f2;
     return s.str();
 }
 
+void MurmurHash::append(const MurmurHash& hash)
+{
+    hash.finalize();
+    append(&hash.m_f1, sizeof(uint64_t));
+    append(&hash.m_f2, sizeof(uint64_t));
+}
+
 void MurmurHash::append(const asf::StringDictionary& dictionary)
 {
     for (auto it = dictionary.begin(), e = dictionary.end(); it != e; ++it)
@@ -53,6 +53,11 @@ namespace renderer   { class ParamArray; }
 // A nice class for hashing arbitrary chunks of data, based on
 // code available at http://code.google.com/p/smhasher.
 //
+// The hash is computed incrementally: appended data is consumed in
+// 16 bytes blocks and partial blocks are buffered until more data
+// arrives. The finalization step only runs when the hash value is
+// needed (comparisons and toString).
+//
 // From that page :
 //
 // "All MurmurHash versions are public domain software, and the
@@ -79,21 +84,30 @@ class MurmurHash
         append(&x, sizeof(T));
     }
 
+    // Hash count contiguous elements in a single pass.
+    template <typename T>
+    void appendSpan(const T* data, const size_t count)
+    {
+        append(static_cast<const void*>(data), sizeof(T) * count);
+    }
+
     void append(const char* str)
     {
-        append(str, strlen(str));
+        appendString(str, strlen(str));
     }
 
     void append(const std::string& str)
     {
-        append(str.c_str(), str.size());
+        appendString(str.c_str(), str.size());
     }
 
     void append(const MString& str)
     {
-        append(str.asChar(), str.length());
+        appendString(str.asChar(), str.length());
     }
 
+    void append(const MurmurHash& hash);
+
     void append(const foundation::StringDictionary& dictionary);
 
     void append(const foundation::Dictionary& dictionary);
@@ -102,9 +116,20 @@ class MurmurHash
 
   private:
     void append(const void* data, size_t bytes);
+    void appendString(const char* str, size_t length);
+
+    void processBlocks(const uint8_t* data, size_t nBlocks);
+    void finalize() const;
+
+    uint64_t            m_h1;
+    uint64_t            m_h2;
+    uint8_t             m_tail[16];
+    size_t              m_tailSize;
+    uint64_t            m_length;
 
-    uint64_t m_h1;
-    uint64_t m_h2;
+    mutable bool        m_finalized;
+    mutable uint64_t    m_f1;
+    mutable uint64_t    m_f2;
 };
 
 std::ostream& operator<<(std::ostream& o, const MurmurHash& hash);
@@ -0,0 +1,120 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "parallel.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/tracer.h"
+
+// Standard headers.
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+
+size_t threadCount()
+{
+    if (const char* threads = getenv("APPLESEED_MAYA_EXPORT_THREADS"))
+    {
+        const int n = atoi(threads);
+        if (n > 0)
+            return static_cast<size_t>(n);
+    }
+
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void parallelFor(const size_t count, const std::function<void(size_t)>& func)
+{
+    const size_t numThreads = std::min(threadCount(), count);
+
+    if (numThreads <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+
+    auto worker = [&]()
+    {
+        while (!failed)
+        {
+            const size_t i = next++;
+            if (i >= count)
+                break;
+
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!exception)
+                    exception = std::current_exception();
+
+                failed = true;
+            }
+        }
+    };
+
+    // The calling thread does its share of the work too.
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (size_t i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back(
+            [&worker]()
+            {
+                Tracer::setThreadName("Export worker");
+                worker();
+            });
+    }
+
+    worker();
+
+    for (size_t i = 0, e = threads.size(); i < e; ++i)
+        threads[i].join();
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+} // Parallel
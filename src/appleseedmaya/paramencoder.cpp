@@ -0,0 +1,257 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "paramencoder.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/utility.h"
+
+// Standard headers.
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace asr = renderer;
+
+namespace
+{
+    double pow10(const int n)
+    {
+        // Powers of ten exactly representable as doubles.
+        static const double ExactPowers[] =
+        {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        if (n >= 0 && n <= 22)
+            return ExactPowers[n];
+
+        return std::pow(10.0, n);
+    }
+
+    // Return value * 10^n.
+    double scale10(const double value, const int n)
+    {
+        return n >= 0 ? value * pow10(n) : value / pow10(-n);
+    }
+
+    size_t copyString(const char* str, char* buffer)
+    {
+        const size_t length = strlen(str);
+        std::memcpy(buffer, str, length);
+        return length;
+    }
+}
+
+ParamEncoder::ParamEncoder()
+{
+    m_buffer.reserve(128);
+}
+
+ParamEncoder& ParamEncoder::begin(const char* type)
+{
+    // Keeps the capacity of the buffer.
+    m_buffer.clear();
+    m_buffer.append(type);
+    return *this;
+}
+
+ParamEncoder& ParamEncoder::append(const float value)
+{
+    char buffer[24];
+    m_buffer.push_back(' ');
+    m_buffer.append(buffer, formatFloat(value, buffer));
+    return *this;
+}
+
+ParamEncoder& ParamEncoder::append(const int value)
+{
+    char buffer[24];
+    m_buffer.push_back(' ');
+    m_buffer.append(buffer, formatInt(value, buffer));
+    return *this;
+}
+
+ParamEncoder& ParamEncoder::append(const char* value)
+{
+    m_buffer.push_back(' ');
+    m_buffer.append(value);
+    return *this;
+}
+
+void ParamEncoder::insert(asr::ParamArray& params, const char* name) const
+{
+    params.insert(name, m_buffer.c_str());
+}
+
+const char* ParamEncoder::c_str() const
+{
+    return m_buffer.c_str();
+}
+
+size_t ParamEncoder::formatFloat(const float value, char* buffer)
+{
+    if (std::isnan(value))
+        return copyString("nan", buffer);
+
+    if (std::isinf(value))
+        return copyString(value < 0.0f ? "-inf" : "inf", buffer);
+
+    if (value == 0.0f)
+        return copyString("0", buffer);
+
+    char* p = buffer;
+    const float absValue = std::fabs(value);
+
+    if (value < 0.0f)
+        *p++ = '-';
+
+    // Decimal exponent of the first significant digit.
+    const double v = absValue;
+    int exponent = static_cast<int>(std::floor(std::log10(v)));
+    if (v < pow10(exponent))
+        --exponent;
+    else if (v >= pow10(exponent + 1))
+        ++exponent;
+
+    // Find the fewest significant digits that read back to the same float.
+    // 9 digits are always enough for single precision floats.
+    std::uint64_t digits = 0;
+    int digitCount;
+
+    for (digitCount = 1; ; ++digitCount)
+    {
+        const int n = digitCount - 1 - exponent;
+        digits = static_cast<std::uint64_t>(scale10(v, n) + 0.5);
+
+        if (digitCount == 9 || static_cast<float>(scale10(static_cast<double>(digits), -n)) == absValue)
+            break;
+    }
+
+    // Rounding up can add a digit, as in 9.96 -> 10 with 2 digits.
+    if (digits >= static_cast<std::uint64_t>(pow10(digitCount)))
+    {
+        digits /= 10;
+        ++exponent;
+    }
+
+    // Remove the trailing zeros.
+    while (digitCount > 1 && digits % 10 == 0)
+    {
+        digits /= 10;
+        --digitCount;
+    }
+
+    char digitChars[9];
+    for (int i = digitCount - 1; i >= 0; --i)
+    {
+        digitChars[i] = static_cast<char>('0' + digits % 10);
+        digits /= 10;
+    }
+
+    if (exponent >= 0 && exponent < 9)
+    {
+        // Positional notation, for example 1250 or 1.25.
+        for (int i = 0; i <= exponent; ++i)
+            *p++ = i < digitCount ? digitChars[i] : '0';
+
+        if (digitCount > exponent + 1)
+        {
+            *p++ = '.';
+            for (int i = exponent + 1; i < digitCount; ++i)
+                *p++ = digitChars[i];
+        }
+    }
+    else if (exponent < 0 && exponent >= -5)
+    {
+        // Positional notation, for example 0.00125.
+        *p++ = '0';
+        *p++ = '.';
+
+        for (int i = -1; i > exponent; --i)
+            *p++ = '0';
+
+        for (int i = 0; i < digitCount; ++i)
+            *p++ = digitChars[i];
+    }
+    else
+    {
+        // Scientific notation, for example 1.25e-07.
+        *p++ = digitChars[0];
+
+        if (digitCount > 1)
+        {
+            *p++ = '.';
+            for (int i = 1; i < digitCount; ++i)
+                *p++ = digitChars[i];
+        }
+
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+
+        const int absExponent = exponent < 0 ? -exponent : exponent;
+        if (absExponent < 10)
+            *p++ = '0';
+
+        p += formatInt(absExponent, p);
+    }
+
+    return static_cast<size_t>(p - buffer);
+}
+
+size_t ParamEncoder::formatInt(const int value, char* buffer)
+{
+    char* p = buffer;
+
+    // Use 64 bits to negate INT_MIN.
+    std::int64_t v = value;
+    if (v < 0)
+    {
+        *p++ = '-';
+        v = -v;
+    }
+
+    char digits[10];
+    size_t digitCount = 0;
+
+    do
+    {
+        digits[digitCount++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    while (digitCount != 0)
+        *p++ = digits[--digitCount];
+
+    return static_cast<size_t>(p - buffer);
+}
@@ -0,0 +1,85 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_PARAMENCODER_H
+#define APPLESEED_MAYA_PARAMENCODER_H
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+#include <string>
+
+// Forward declarations.
+namespace renderer { class ParamArray; }
+
+//
+// Encodes shader parameter values in the text form parsed by appleseed,
+// for example "color 0.5 0.5 0.5" or "float[] 0 0.25 1".
+//
+// Numbers are formatted without locale and floats are written with the fewest
+// digits that read back to the same value. The buffer is reused by the values
+// encoded after it, so an encoder kept around allocates memory only when a
+// value is longer than all the previous ones.
+//
+
+class ParamEncoder
+  : public foundation::NonCopyable
+{
+  public:
+    ParamEncoder();
+
+    // Start a new value of the given type, for example "color" or "int[]".
+    ParamEncoder& begin(const char* type);
+
+    ParamEncoder& append(const float value);
+    ParamEncoder& append(const int value);
+
+    // Append a string as is.
+    ParamEncoder& append(const char* value);
+
+    // Insert the value into a parameter array.
+    void insert(renderer::ParamArray& params, const char* name) const;
+
+    const char* c_str() const;
+
+    // Write the shortest representation of a float that reads back to the same value.
+    // Return the number of characters written to buffer, at most 16, without null terminator.
+    static size_t formatFloat(const float value, char* buffer);
+
+    // Return the number of characters written to buffer, at most 11, without null terminator.
+    static size_t formatInt(const int value, char* buffer);
+
+  private:
+    std::string m_buffer;
+};
+
+#endif  // !APPLESEED_MAYA_PARAMENCODER_H
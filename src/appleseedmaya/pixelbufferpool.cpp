@@ -0,0 +1,141 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "pixelbufferpool.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/logger.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace asf = foundation;
+
+namespace
+{
+    // Pooled buffers, indexed by capacity.
+    std::multimap<size_t, RV_PIXEL*> g_buffers;
+    std::mutex g_mutex;
+
+    size_t g_acquiredBuffers = 0;
+    size_t g_allocatedBuffers = 0;
+    size_t g_allocatedBytes = 0;
+    size_t g_peakAllocatedBytes = 0;
+}
+
+namespace PixelBufferPool
+{
+
+void BufferReleaser::operator()(RV_PIXEL* pixels) const
+{
+    if (pixels == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_buffers.insert(std::make_pair(m_capacity, pixels));
+}
+
+PixelBuffer acquire(const size_t pixelCount, const size_t granularity)
+{
+    const size_t g = std::max(granularity, size_t(1));
+    const size_t capacity = (pixelCount + g - 1) / g * g;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    ++g_acquiredBuffers;
+
+    // Reuse the smallest pooled buffer that fits, unless it is much bigger than needed.
+    auto it = g_buffers.lower_bound(capacity);
+    if (it != g_buffers.end() && it->first <= 2 * capacity)
+    {
+        BufferReleaser releaser = {it->first};
+        PixelBuffer buffer(it->second, releaser);
+        g_buffers.erase(it);
+        return buffer;
+    }
+
+    ++g_allocatedBuffers;
+    g_allocatedBytes += capacity * sizeof(RV_PIXEL);
+    g_peakAllocatedBytes = std::max(g_peakAllocatedBytes, g_allocatedBytes);
+
+    BufferReleaser releaser = {capacity};
+    return PixelBuffer(new RV_PIXEL[capacity], releaser);
+}
+
+void releaseUnusedBuffers()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    for (auto it = g_buffers.begin(), e = g_buffers.end(); it != e; ++it)
+    {
+        g_allocatedBytes -= it->first * sizeof(RV_PIXEL);
+        delete[] it->second;
+    }
+
+    g_buffers.clear();
+}
+
+Statistics statistics()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    Statistics stats;
+    stats.m_acquiredBuffers = g_acquiredBuffers;
+    stats.m_allocatedBuffers = g_allocatedBuffers;
+    stats.m_allocatedBytes = g_allocatedBytes;
+    stats.m_peakAllocatedBytes = g_peakAllocatedBytes;
+    return stats;
+}
+
+void resetStatistics()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_acquiredBuffers = 0;
+    g_allocatedBuffers = 0;
+    g_peakAllocatedBytes = g_allocatedBytes;
+}
+
+void logStatistics()
+{
+    const Statistics stats = statistics();
+
+    if (stats.m_acquiredBuffers == 0)
+        return;
+
+    RENDERER_LOG_DEBUG(
+        "Pixel buffers: %s acquired, %s allocated, peak memory %s",
+        asf::pretty_uint(stats.m_acquiredBuffers).c_str(),
+        asf::pretty_uint(stats.m_allocatedBuffers).c_str(),
+        asf::pretty_size(stats.m_peakAllocatedBytes).c_str());
+}
+
+} // PixelBufferPool
@@ -0,0 +1,84 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_PIXELBUFFERPOOL_H
+#define APPLESEED_MAYA_PIXELBUFFERPOOL_H
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MRenderView.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <cstddef>
+#include <memory>
+
+//
+// Thread safe pool of render view pixel buffers.
+//
+// Buffer sizes are rounded up to a multiple of a granularity, usually the number
+// of pixels of a tile, so that buffers can be reused for similar requests.
+// Buffers return to the pool when released and are freed by releaseUnusedBuffers().
+//
+
+namespace PixelBufferPool
+{
+
+// Return a buffer to the pool.
+struct BufferReleaser
+{
+    size_t m_capacity;
+
+    void operator()(RV_PIXEL* pixels) const;
+};
+
+typedef std::unique_ptr<RV_PIXEL[], BufferReleaser> PixelBuffer;
+
+// Get a buffer of at least pixelCount pixels. Thread safe.
+PixelBuffer acquire(const size_t pixelCount, const size_t granularity);
+
+// Free the buffers not in use.
+void releaseUnusedBuffers();
+
+struct Statistics
+{
+    size_t  m_acquiredBuffers;      // number of buffers acquired
+    size_t  m_allocatedBuffers;     // number of buffers allocated because no pooled buffer fitted
+    size_t  m_allocatedBytes;       // bytes currently allocated, including pooled buffers
+    size_t  m_peakAllocatedBytes;   // maximum number of bytes allocated at any time
+};
+
+// Return the allocation counters since the last call to resetStatistics().
+Statistics statistics();
+void resetStatistics();
+
+// Log the allocation counters.
+void logStatistics();
+
+} // PixelBufferPool
+
+#endif  // !APPLESEED_MAYA_PIXELBUFFERPOOL_H
@@ -0,0 +1,328 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "pixelkernels.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define APPLESEED_MAYA_X86_KERNELS
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__)
+#define APPLESEED_MAYA_TARGET_AVX __attribute__((target("avx")))
+#else
+#define APPLESEED_MAYA_TARGET_AVX
+#endif
+
+namespace
+{
+    typedef void (*ConvertFun)(const float*, std::uint8_t*, size_t);
+
+    //
+    // sRGB lookup table, indexed by the linear value quantized to 12 bits.
+    //
+
+    const size_t SRGBTableSize = 4096;
+
+    struct SRGBTable
+    {
+        std::uint8_t m_values[SRGBTableSize];
+
+        SRGBTable()
+        {
+            for (size_t i = 0; i < SRGBTableSize; ++i)
+            {
+                const float c = static_cast<float>(i) / (SRGBTableSize - 1);
+                const float s = c <= 0.0031308f
+                    ? c * 12.92f
+                    : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                m_values[i] = static_cast<std::uint8_t>(std::min(s, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    const SRGBTable g_srgbTable;
+
+    inline float saturate(const float c)
+    {
+        return c > 0.0f ? (c < 1.0f ? c : 1.0f) : 0.0f;
+    }
+
+    inline std::uint8_t toUInt8(const float c)
+    {
+        return static_cast<std::uint8_t>(saturate(c) * 255.0f);
+    }
+
+    inline std::uint8_t toSRGB8(const float c)
+    {
+        return g_srgbTable.m_values[static_cast<size_t>(saturate(c) * (SRGBTableSize - 1) + 0.5f)];
+    }
+
+    //
+    // Scalar kernels.
+    //
+
+    void convertScalar(const float* src, std::uint8_t* dst, const size_t pixelCount)
+    {
+        for (size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4)
+        {
+            dst[0] = toUInt8(src[2]);
+            dst[1] = toUInt8(src[1]);
+            dst[2] = toUInt8(src[0]);
+            dst[3] = 255;
+        }
+    }
+
+    void convertSRGBScalar(const float* src, std::uint8_t* dst, const size_t pixelCount)
+    {
+        for (size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4)
+        {
+            dst[0] = toSRGB8(src[2]);
+            dst[1] = toSRGB8(src[1]);
+            dst[2] = toSRGB8(src[0]);
+            dst[3] = 255;
+        }
+    }
+
+#ifdef APPLESEED_MAYA_X86_KERNELS
+
+    //
+    // SSE kernels.
+    //
+
+    // Clamp an RGBA pixel to [0, 1], reorder it to BGRA and scale it to [0, 255].
+    inline __m128i toBGRA8SSE(const float* src)
+    {
+        __m128 v = _mm_loadu_ps(src);
+        v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        return _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(255.0f)));
+    }
+
+    void convertSSE(const float* src, std::uint8_t* dst, const size_t pixelCount)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+        size_t i = 0;
+        for (; i + 4 <= pixelCount; i += 4, src += 16, dst += 16)
+        {
+            const __m128i p01 = _mm_packs_epi32(toBGRA8SSE(src), toBGRA8SSE(src + 4));
+            const __m128i p23 = _mm_packs_epi32(toBGRA8SSE(src + 8), toBGRA8SSE(src + 12));
+            const __m128i bytes = _mm_or_si128(_mm_packus_epi16(p01, p23), alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bytes);
+        }
+
+        convertScalar(src, dst, pixelCount - i);
+    }
+
+    void convertSRGBSSE(const float* src, std::uint8_t* dst, const size_t pixelCount)
+    {
+        const __m128 scale = _mm_set1_ps(static_cast<float>(SRGBTableSize - 1));
+        const __m128 half = _mm_set1_ps(0.5f);
+
+        for (size_t i = 0; i < pixelCount; ++i, src += 4, dst += 4)
+        {
+            __m128 v = _mm_loadu_ps(src);
+            v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+            v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+            alignas(16) std::int32_t index[4];
+            _mm_store_si128(
+                reinterpret_cast<__m128i*>(index),
+                _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)));
+
+            dst[0] = g_srgbTable.m_values[index[0]];
+            dst[1] = g_srgbTable.m_values[index[1]];
+            dst[2] = g_srgbTable.m_values[index[2]];
+            dst[3] = 255;
+        }
+    }
+
+    //
+    // AVX kernels.
+    //
+
+    // Same as toBGRA8SSE, for two pixels.
+    APPLESEED_MAYA_TARGET_AVX
+    inline __m256i toBGRA8AVX(const float* src)
+    {
+        __m256 v = _mm256_loadu_ps(src);
+        v = _mm256_permute_ps(v, _MM_SHUFFLE(3, 0, 1, 2));
+        v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        return _mm256_cvttps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)));
+    }
+
+    APPLESEED_MAYA_TARGET_AVX
+    void convertAVX(const float* src, std::uint8_t* dst, const size_t pixelCount)
+    {
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+        size_t i = 0;
+        for (; i + 4 <= pixelCount; i += 4, src += 16, dst += 16)
+        {
+            const __m256i p01 = toBGRA8AVX(src);
+            const __m256i p23 = toBGRA8AVX(src + 8);
+
+            // AVX has no 256 bit integer packing, pack the 128 bit halves.
+            const __m128i lo = _mm_packs_epi32(_mm256_castsi256_si128(p01), _mm256_extractf128_si256(p01, 1));
+            const __m128i hi = _mm_packs_epi32(_mm256_castsi256_si128(p23), _mm256_extractf128_si256(p23, 1));
+            const __m128i bytes = _mm_or_si128(_mm_packus_epi16(lo, hi), alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bytes);
+        }
+
+        convertScalar(src, dst, pixelCount - i);
+    }
+
+    APPLESEED_MAYA_TARGET_AVX
+    void convertSRGBAVX(const float* src, std::uint8_t* dst, const size_t pixelCount)
+    {
+        const __m256 scale = _mm256_set1_ps(static_cast<float>(SRGBTableSize - 1));
+        const __m256 half = _mm256_set1_ps(0.5f);
+
+        size_t i = 0;
+        for (; i + 2 <= pixelCount; i += 2, src += 8, dst += 8)
+        {
+            __m256 v = _mm256_loadu_ps(src);
+            v = _mm256_permute_ps(v, _MM_SHUFFLE(3, 0, 1, 2));
+            v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+
+            alignas(32) std::int32_t index[8];
+            _mm256_store_si256(
+                reinterpret_cast<__m256i*>(index),
+                _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half)));
+
+            dst[0] = g_srgbTable.m_values[index[0]];
+            dst[1] = g_srgbTable.m_values[index[1]];
+            dst[2] = g_srgbTable.m_values[index[2]];
+            dst[3] = 255;
+            dst[4] = g_srgbTable.m_values[index[4]];
+            dst[5] = g_srgbTable.m_values[index[5]];
+            dst[6] = g_srgbTable.m_values[index[6]];
+            dst[7] = 255;
+        }
+
+        convertSRGBScalar(src, dst, pixelCount - i);
+    }
+
+    bool cpuSupportsAVX()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+
+        // Check that the CPU supports AVX and that the OS saves the AVX registers.
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#else
+        return __builtin_cpu_supports("avx") != 0;
+#endif
+    }
+
+#endif  // APPLESEED_MAYA_X86_KERNELS
+
+    struct Kernels
+    {
+        const char*     m_name;
+        ConvertFun      m_convert;
+        ConvertFun      m_convertSRGB;
+    };
+
+    Kernels selectKernels()
+    {
+        const Kernels scalar = {"scalar", &convertScalar, &convertSRGBScalar};
+
+#ifdef APPLESEED_MAYA_X86_KERNELS
+        const Kernels sse = {"sse", &convertSSE, &convertSRGBSSE};
+        const Kernels avx = {"avx", &convertAVX, &convertSRGBAVX};
+
+        const char* forced = getenv("APPLESEED_MAYA_PIXEL_KERNELS");
+
+        if (forced && strcmp(forced, "scalar") == 0)
+            return scalar;
+
+        if (forced && strcmp(forced, "sse") == 0)
+            return sse;
+
+        return cpuSupportsAVX() ? avx : sse;
+#else
+        return scalar;
+#endif
+    }
+
+    const Kernels& kernels()
+    {
+        static const Kernels k = selectKernels();
+        return k;
+    }
+}
+
+namespace PixelKernels
+{
+
+void copyRGBAFloatFlipped(
+    const float*            src,
+    const size_t            srcStride,
+    float*                  dst,
+    const size_t            dstStride,
+    const size_t            width,
+    const size_t            height)
+{
+    // Rows are copied with memcpy, which is at least as fast
+    // as SSE or AVX loops for this memory bound copy.
+    for (size_t j = 0; j < height; ++j)
+        std::memcpy(dst + (height - 1 - j) * dstStride, src + j * srcStride, width * 4 * sizeof(float));
+}
+
+void convertRGBAFloatToBGRA8(
+    const float*            src,
+    std::uint8_t*           dst,
+    const size_t            pixelCount,
+    const DisplayTransform  transform)
+{
+    if (transform == SRGBTransform)
+        kernels().m_convertSRGB(src, dst, pixelCount);
+    else
+        kernels().m_convert(src, dst, pixelCount);
+}
+
+const char* instructionSet()
+{
+    return kernels().m_name;
+}
+
+} // PixelKernels
@@ -0,0 +1,76 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_PIXELKERNELS_H
+#define APPLESEED_MAYA_PIXELKERNELS_H
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+
+//
+// Pixel conversion kernels used to send rendered images to Maya.
+//
+// SSE and AVX versions of the conversion kernels are selected at runtime depending on the CPU.
+// The APPLESEED_MAYA_PIXEL_KERNELS environment variable can be set to scalar, sse
+// or avx to force a particular version.
+//
+
+namespace PixelKernels
+{
+
+enum DisplayTransform
+{
+    NoTransform,
+    SRGBTransform       // linear to sRGB, using a lookup table
+};
+
+// Copy rows of RGBA float pixels, flipping them vertically.
+// Source row j is copied to destination row height - 1 - j.
+// Strides are in floats.
+void copyRGBAFloatFlipped(
+    const float*            src,
+    const size_t            srcStride,
+    float*                  dst,
+    const size_t            dstStride,
+    const size_t            width,
+    const size_t            height);
+
+// Convert RGBA float pixels to 8 bit BGRA pixels. Colors are clamped to [0, 1]
+// and the alpha of the destination pixels is set to 255.
+void convertRGBAFloatToBGRA8(
+    const float*            src,
+    std::uint8_t*           dst,
+    const size_t            pixelCount,
+    const DisplayTransform  transform = NoTransform);
+
+// Return the name of the version of the kernels in use.
+const char* instructionSet();
+
+} // PixelKernels
+
+#endif  // !APPLESEED_MAYA_PIXELKERNELS_H
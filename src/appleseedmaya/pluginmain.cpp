@@ -40,7 +40,10 @@
 #include "appleseedmaya/rendercommands.h"
 #include "appleseedmaya/renderglobalsnode.h"
 #include "appleseedmaya/shadingnoderegistry.h"
+#include "appleseedmaya/startupstatistics.h"
+#include "appleseedmaya/statscommands.h"
 #include "appleseedmaya/swatchrenderer.h"
+#include "appleseedmaya/tracer.h"
 
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
@@ -49,6 +52,9 @@
 #include <maya/MSwatchRenderRegister.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
+// Standard headers.
+#include <chrono>
+
 // Must be last to avoid conflicts with symbols defined in X headers.
 #include "appleseedmaya/physicalskylightnode.h"
 #include "appleseedmaya/skydomelightnode.h"
@@ -61,6 +67,8 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
     /***************************/
     // Plugin.
 
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
     MStatus status;
     MFnPlugin fnPlugin(
         plugin,
@@ -84,6 +92,11 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
 
     RENDERER_LOG_INFO("Initializing appleseedMaya plugin");
 
+    status = Tracer::initialize();
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: failed to initialize tracer");
+
     /***************************/
     // Nodes.
 
@@ -157,6 +170,30 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
         status,
         "appleseedMaya: failed to register final render command");
 
+    status = fnPlugin.registerCommand(
+        ExportStatsCommand::cmdName,
+        ExportStatsCommand::creator,
+        ExportStatsCommand::syntaxCreator);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: failed to register export stats command");
+
+    status = fnPlugin.registerCommand(
+        IdleJobQueueStatsCommand::cmdName,
+        IdleJobQueueStatsCommand::creator,
+        IdleJobQueueStatsCommand::syntaxCreator);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: failed to register idle job queue stats command");
+
+    status = fnPlugin.registerCommand(
+        StartupStatsCommand::cmdName,
+        StartupStatsCommand::creator,
+        StartupStatsCommand::syntaxCreator);
+    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG(
+        status,
+        "appleseedMaya: failed to register startup stats command");
+
     if (MGlobal::mayaState() == MGlobal::kInteractive)
     {
         status = fnPlugin.registerCommand(
@@ -179,21 +216,25 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
     /***************************/
     // Scripts.
 
-    // Make sure that the modules we need can be imported.
-    status = MGlobal::executePythonCommand("import appleseed", false, false);
-    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
-        status,
-        "appleseedMaya: failed to import required Python modules");
+    {
+        StartupStatistics::ScopedStep step("pythonModules");
 
-    status = MGlobal::executePythonCommand("import appleseedMaya", false, false);
-    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
-        status,
-        "appleseedMaya: failed to import required Python modules");
+        // Make sure that the modules we need can be imported.
+        status = MGlobal::executePythonCommand("import appleseed", false, false);
+        APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
+            status,
+            "appleseedMaya: failed to import required Python modules");
 
-    status = MGlobal::executePythonCommand("import appleseedMaya.register; appleseedMaya.register.register()", false, false);
-    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
-        status,
-        "appleseedMaya: failed to initialize renderer");
+        status = MGlobal::executePythonCommand("import appleseedMaya", false, false);
+        APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
+            status,
+            "appleseedMaya: failed to import required Python modules");
+
+        status = MGlobal::executePythonCommand("import appleseedMaya.register; appleseedMaya.register.register()", false, false);
+        APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
+            status,
+            "appleseedMaya: failed to initialize renderer");
+    }
 
     /***************************/
     // Shading nodes & previews.
@@ -205,7 +246,11 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
 
     if (MGlobal::mayaState() == MGlobal::kInteractive)
     {
-        SwatchRenderer::initialize(pluginPath);
+        {
+            StartupStatistics::ScopedStep step("swatchInit");
+            SwatchRenderer::initialize(pluginPath);
+        }
+
         status = MSwatchRenderRegister::registerSwatchRender(
             SwatchRenderer::name,
             SwatchRenderer::creator);
@@ -260,14 +305,20 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus initializePlugin(MObject plugin)
         status,
         "appleseedMaya: failed to initialize session");
 
-    status = PythonBridge::initialize(pluginPath);
-    APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
-        status,
-        "appleseedMaya: failed to initialize Python bridge");
+    {
+        StartupStatistics::ScopedStep step("pythonBridge");
+
+        status = PythonBridge::initialize(pluginPath);
+        APPLESEED_MAYA_CHECK_MSTATUS_RET_MSG_LOG(
+            status,
+            "appleseedMaya: failed to initialize Python bridge");
+    }
 
     IdleJobQueue::initialize();
 
     RENDERER_LOG_INFO("Registration done!");
+    StartupStatistics::finish(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
     return status;
 }
 
@@ -339,6 +390,21 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus uninitializePlugin(MObject plugin)
         status,
         "appleseedMaya: failed to deregister render command");
 
+    status = fnPlugin.deregisterCommand(ExportStatsCommand::cmdName);
+    APPLESEED_MAYA_CHECK_MSTATUS_MSG_LOG(
+        status,
+        "appleseedMaya: failed to deregister export stats command");
+
+    status = fnPlugin.deregisterCommand(IdleJobQueueStatsCommand::cmdName);
+    APPLESEED_MAYA_CHECK_MSTATUS_MSG_LOG(
+        status,
+        "appleseedMaya: failed to deregister idle job queue stats command");
+
+    status = fnPlugin.deregisterCommand(StartupStatsCommand::cmdName);
+    APPLESEED_MAYA_CHECK_MSTATUS_MSG_LOG(
+        status,
+        "appleseedMaya: failed to deregister startup stats command");
+
     if (MGlobal::mayaState() == MGlobal::kInteractive)
     {
         status = fnPlugin.deregisterCommand(ProgressiveRenderCommand::cmdName);
@@ -408,6 +474,11 @@ APPLESEED_MAYA_PLUGIN_EXPORT MStatus uninitializePlugin(MObject plugin)
         status,
         "appleseedMaya: failed to uninitialize render");
 
+    status = Tracer::uninitialize();
+    APPLESEED_MAYA_CHECK_MSTATUS_MSG_LOG(
+        status,
+        "appleseedMaya: failed to uninitialize tracer");
+
     /***************************/
     // Logger.
 
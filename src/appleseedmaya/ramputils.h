@@ -29,6 +29,9 @@
 #ifndef APPLESEED_MAYA_RAMP_UTILS_H
 #define APPLESEED_MAYA_RAMP_UTILS_H
 
+// appleseed-maya headers.
+#include "appleseedmaya/paramencoder.h"
+
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
 #include <maya/MColor.h>
@@ -37,8 +40,6 @@
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
-#include <sstream>
-#include <string>
 #include <vector>
 
 template <typename T>
@@ -72,9 +73,9 @@ template <> struct RampEntryTraits<MColor>
         return "color[]";
     }
 
-    static void outputValue(std::stringstream& ss, const MColor& value)
+    static void outputValue(ParamEncoder& encoder, const MColor& value)
     {
-        ss << value.r << " " << value.g << " " << value.b << " ";
+        encoder.append(value.r).append(value.g).append(value.b);
     }
 };
 
@@ -87,32 +88,26 @@ template <> struct RampEntryTraits<float>
         return "float[]";
     }
 
-    static void outputValue(std::stringstream& ss, const float& value)
+    static void outputValue(ParamEncoder& encoder, const float& value)
     {
-        ss << value << " ";
+        encoder.append(value);
     }
 };
 
 template <typename T>
 void serializeRamp(
     const std::vector<RampEntry<T>>& entries,
-    std::string&                     outValues,
-    std::string&                     outPositions)
+    ParamEncoder&                    outValues,
+    ParamEncoder&                    outPositions)
 {
-    std::stringstream ssp;
-    ssp << "float[] ";
-
-    std::stringstream ssv;
-    ssv << RampEntryTraits<T>::paramValueTypeName() << " ";
+    outPositions.begin("float[]");
+    outValues.begin(RampEntryTraits<T>::paramValueTypeName());
 
     for (size_t i = 0, e = entries.size(); i < e; ++i)
     {
-        ssp << entries[i].m_pos << " ";
-        RampEntryTraits<T>::outputValue(ssv, entries[i].m_value);
+        outPositions.append(entries[i].m_pos);
+        RampEntryTraits<T>::outputValue(outValues, entries[i].m_value);
     }
-
-    outValues = ssv.str();
-    outPositions = ssp.str();
 }
 
 #endif  // !APPLESEED_MAYA_RAMP_UTILS_H
@@ -147,6 +147,7 @@ MSyntax ProgressiveRenderCommand::syntaxCreator()
     syntax.addFlag("-w", "-width" , MSyntax::kLong);
     syntax.addFlag("-h", "-height", MSyntax::kLong);
     syntax.addFlag("-a", "-action" , MSyntax::kString);
+    syntax.addFlag("-p", "-pause" , MSyntax::kBoolean);
     return syntax;
 }
 
@@ -157,67 +158,89 @@ void* ProgressiveRenderCommand::creator()
 
 MStatus ProgressiveRenderCommand::doIt(const MArgList& args)
 {
-    // Maybe we should check and fail instead of asserting?
-    //assert(MRenderView::doesRenderEditorExist());
-
-    /*
-    // In case we were rendering.
-    AppleseedSession::endSession();
-
-    AppleseedSession::Options options;
-
     MStatus status;
     MArgDatabase argData(syntax(), args, &status);
 
-    if (argData.isFlagSet("-width", &status))
-        status = argData.getFlagArgument("-width", 0, options.m_width);
-
-    if (argData.isFlagSet("-height", &status))
-        status = argData.getFlagArgument("-height", 0, options.m_height);
-
-    if (argData.isFlagSet("-camera", &status))
-        status = argData.getFlagArgument("-camera", 0, options.m_camera);
-
     MString action;
     if (argData.isFlagSet("-action", &status))
         status = argData.getFlagArgument("-action", 0, action);
 
-    if (action == "start")
+    const bool iprRunning =
+        AppleseedSession::sessionMode() == AppleseedSession::ProgressiveRenderSession;
+
+    if (action == "start" || action == "render" || action.length() == 0)
     {
-        // ...
+        AppleseedSession::Options options;
+
+        MCommonRenderSettingsData renderSettings;
+        MRenderUtil::getCommonRenderSettings(renderSettings);
+
+        options.m_width = renderSettings.width;
+        options.m_height = renderSettings.height;
+
+        if (argData.isFlagSet("-width", &status))
+            status = argData.getFlagArgument("-width", 0, options.m_width);
+
+        if (argData.isFlagSet("-height", &status))
+            status = argData.getFlagArgument("-height", 0, options.m_height);
+
+        if (argData.isFlagSet("-camera", &status))
+            status = argData.getFlagArgument("-camera", 0, options.m_camera);
+
+        return AppleseedSession::progressiveRender(options);
     }
     else if (action == "stop")
     {
-        // ...
+        if (iprRunning)
+            AppleseedSession::endSession();
     }
     else if (action == "refresh")
     {
-        // ...
+        // Export the whole scene again.
+        if (iprRunning)
+            return AppleseedSession::progressiveRender(AppleseedSession::options());
     }
     else if (action == "running")
     {
-        const int iprRunning =
-            AppleseedSession::sessionMode() == AppleseedSession::ProgressiveRenderSession;
-        setResult(iprRunning);
+        setResult(iprRunning ? 1 : 0);
     }
     else if (action == "pause")
     {
-        // ...
+        bool pause = true;
+        if (argData.isFlagSet("-pause", &status))
+            status = argData.getFlagArgument("-pause", 0, pause);
+
+        AppleseedSession::pauseProgressiveRender(pause);
     }
     else if (action == "region")
     {
-        // ...
-    }
-    else if (action.length() == 0)
-    {
-        // default action here
+        if (iprRunning)
+        {
+            AppleseedSession::Options options = AppleseedSession::options();
+
+            unsigned int left, right, bottom, top;
+            if (MRenderView::getRenderRegion(left, right, bottom, top))
+            {
+                options.m_renderRegion = true;
+                options.m_xmin = static_cast<int>(left);
+                options.m_xmax = static_cast<int>(right);
+                options.m_ymin = static_cast<int>(bottom);
+                options.m_ymax = static_cast<int>(top);
+
+                // Flip the render region vertically (Maya is Y up).
+                flip_pixel_interval(options.m_height, options.m_ymin, options.m_ymax);
+            }
+            else
+                options.m_renderRegion = false;
+
+            return AppleseedSession::progressiveRender(options);
+        }
     }
     else
     {
         MGlobal::displayError("appleseedProgressiveRender: Unknown action argument.");
         return MS::kFailure;
     }
-    */
 
     return MS::kSuccess;
 }
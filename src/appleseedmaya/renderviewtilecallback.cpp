@@ -31,6 +31,8 @@
 
 // appleseed-maya headers.
 #include "appleseedmaya/idlejobqueue.h"
+#include "appleseedmaya/renderviewupdater.h"
+#include "appleseedmaya/tracer.h"
 #include "appleseedmaya/utils.h"
 
 // Build options header.
@@ -55,6 +57,7 @@
 // Standard headers.
 #include <cassert>
 #include <memory>
+#include <string>
 
 namespace asf = foundation;
 namespace asr = renderer;
@@ -71,11 +74,13 @@ namespace
             const asf::AABB2i&      displayWindow,
             const asf::AABB2i&      dataWindow,
             RendererController&     rendererController,
-            ComputationPtr&         computation)
+            ComputationPtr&         computation,
+            RenderViewUpdaterPtr    updater)
           : m_displayWindow(displayWindow)
           , m_dataWindow(dataWindow)
           , m_rendererController(rendererController)
           , m_computation(computation)
+          , m_updater(updater)
         {
             for (int i = 0; i < MaxHighlightSize; ++i)
             {
@@ -96,6 +101,14 @@ namespace
             const size_t            tile_x,
             const size_t            tile_y) override
         {
+            if (Tracer::enabled())
+            {
+                Tracer::beginEvent(
+                    "render",
+                    "tile",
+                    "\"x\":" + std::to_string(tile_x) + ",\"y\":" + std::to_string(tile_y));
+            }
+
             // Temporarily disabled.
             /*
             const asf::CanvasProperties& props = frame->image().properties();
@@ -113,10 +126,15 @@ namespace
             const size_t            tile_y) override
         {
             write_tile(frame, tile_x, tile_y);
+
+            if (Tracer::enabled())
+                Tracer::endEvent("render");
         }
 
         void on_progressive_frame_update(const asr::Frame* frame) override
         {
+            Tracer::ScopedEvent event("render", "progressiveFrameUpdate");
+
             const asf::CanvasProperties& props = frame->image().properties();
 
             for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
@@ -196,47 +214,6 @@ namespace
             ComputationPtr      m_computation;
         };
 
-        struct WriteTileToRenderView
-        {
-            WriteTileToRenderView(
-                const size_t                    xmin,
-                const size_t                    ymin,
-                const size_t                    xmax,
-                const size_t                    ymax,
-                std::shared_ptr<RV_PIXEL>       pixels,
-                RendererController&             rendererController,
-                ComputationPtr                  computation)
-              : m_xmin(static_cast<unsigned int>(xmin))
-              , m_ymin(static_cast<unsigned int>(ymin))
-              , m_xmax(static_cast<unsigned int>(xmax))
-              , m_ymax(static_cast<unsigned int>(ymax))
-              , m_pixels(pixels)
-              , m_rendererController(rendererController)
-              , m_computation(computation)
-            {
-            }
-
-            void operator()()
-            {
-                if (m_computation && m_computation->isInterruptRequested())
-                {
-                    m_rendererController.set_status(RendererController::AbortRendering);
-                    return;
-                }
-
-                MRenderView::updatePixels(m_xmin, m_xmax, m_ymin, m_ymax, m_pixels.get(), true);
-                MRenderView::refresh(m_xmin, m_xmax, m_ymin, m_ymax);
-            }
-
-            const unsigned int              m_xmin;
-            const unsigned int              m_ymin;
-            const unsigned int              m_xmax;
-            const unsigned int              m_ymax;
-            std::shared_ptr<RV_PIXEL>       m_pixels;
-            RendererController&             m_rendererController;
-            ComputationPtr                  m_computation;
-        };
-
         void pre_render(
             const size_t        x,
             const size_t        y,
@@ -258,6 +235,8 @@ namespace
             // Flip Y interval vertically (Maya is Y up).
             flip_pixel_interval(displayWindowHeight(), ymin, ymax);
             HighlightTile highlightJob(xmin, ymin, xmax, ymax, lineSize, m_highlightPixels, m_rendererController, m_computation);
+
+            // The highlight is skipped if the idle job queue is full.
             IdleJobQueue::pushJob(highlightJob);
         }
 
@@ -266,46 +245,7 @@ namespace
             const size_t        tile_x,
             const size_t        tile_y)
         {
-            const foundation::Tile& tile = frame->image().tile(tile_x, tile_y);
-            assert(tile.get_pixel_format() == foundation::PixelFormatFloat);
-            assert(tile.get_channel_count() == 4);
-
-            const asf::CanvasProperties& props = frame->image().properties();
-            const int x0 = static_cast<int>(tile_x * props.m_tile_width);
-            const int y0 = static_cast<int>(tile_y * props.m_tile_height);
-
-            int xmin = x0;
-            int ymin = y0;
-            int xmax = xmin + static_cast<int>(tile.get_width()) - 1;
-            int ymax = ymin + static_cast<int>(tile.get_height()) - 1;
-
-            if (!intersect_with_data_window(xmin, ymin, xmax, ymax))
-                return;
-
-            const size_t w = xmax - xmin + 1;
-            const size_t h = ymax - ymin + 1;
-            std::shared_ptr<RV_PIXEL> pixels(new RV_PIXEL[w * h], ArrayDeleter<RV_PIXEL>());
-            RV_PIXEL* p = pixels.get();
-
-            // Copy and flip the tile verticaly (Maya's renderview is y up).
-            for (int j = ymax; j >= ymin; --j)
-            {
-                size_t y = j - y0;
-
-                for (int i = xmin; i <= xmax; ++i)
-                {
-                    const size_t x = i - x0;
-                    p->r = tile.get_component<float>(x, y, 0);
-                    p->g = tile.get_component<float>(x, y, 1);
-                    p->b = tile.get_component<float>(x, y, 2);
-                    p->a = tile.get_component<float>(x, y, 3);
-                    p++;
-                }
-            }
-
-            flip_pixel_interval(displayWindowHeight(), ymin, ymax);
-            WriteTileToRenderView tileJob(xmin, ymin, xmax, ymax, pixels, m_rendererController, m_computation);
-            IdleJobQueue::pushJob(tileJob);
+            m_updater->writeTile(frame->image().tile(tile_x, tile_y), tile_x, tile_y);
         }
 
         int displayWindowHeight() const
@@ -330,11 +270,12 @@ namespace
             return true;
         }
 
-        RV_PIXEL            m_highlightPixels[MaxHighlightSize];
-        const asf::AABB2i   m_displayWindow;
-        const asf::AABB2i   m_dataWindow;
-        RendererController& m_rendererController;
-        ComputationPtr      m_computation;
+        RV_PIXEL                m_highlightPixels[MaxHighlightSize];
+        const asf::AABB2i       m_displayWindow;
+        const asf::AABB2i       m_dataWindow;
+        RendererController&     m_rendererController;
+        ComputationPtr          m_computation;
+        RenderViewUpdaterPtr    m_updater;
     };
 }
 
@@ -348,6 +289,9 @@ RenderViewTileCallbackFactory::RenderViewTileCallbackFactory(
 
 RenderViewTileCallbackFactory::~RenderViewTileCallbackFactory()
 {
+    if (m_updater)
+        m_updater->finish();
+
     MRenderView::endRender();
 }
 
@@ -362,7 +306,8 @@ renderer::ITileCallback* RenderViewTileCallbackFactory::create()
         m_displayWindow,
         m_dataWindow,
         m_rendererController,
-        m_computation);
+        m_computation,
+        m_updater);
 }
 
 void RenderViewTileCallbackFactory::renderViewStart(const renderer::Frame& frame)
@@ -396,4 +341,18 @@ void RenderViewTileCallbackFactory::renderViewStart(const renderer::Frame& frame
         m_dataWindow = m_displayWindow;
         MRenderView::startRender(width, height, false, true);
     }
+
+    m_updater = std::make_shared<RenderViewUpdater>(
+        m_displayWindow,
+        m_dataWindow,
+        frameProps.m_tile_width,
+        frameProps.m_tile_height,
+        m_rendererController,
+        m_computation);
+}
+
+void RenderViewTileCallbackFactory::measureEditLatency(const std::chrono::steady_clock::time_point& editTime)
+{
+    if (m_updater)
+        m_updater->measureEditLatency(editTime);
 }
@@ -48,11 +48,15 @@
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
+#include <chrono>
 #include <cstddef>
+#include <memory>
 
 // Forward declarations.
 namespace foundation    { class Tile; }
 namespace renderer      { class Frame; }
+class RenderViewUpdater;
+typedef std::shared_ptr<RenderViewUpdater> RenderViewUpdaterPtr;
 
 
 class RenderViewTileCallbackFactory
@@ -71,11 +75,15 @@ class RenderViewTileCallbackFactory
 
     void renderViewStart(const renderer::Frame& frame);
 
+    // Measure the latency of a scene edit, see RenderViewUpdater.
+    void measureEditLatency(const std::chrono::steady_clock::time_point& editTime);
+
   private:
-    RendererController& m_rendererController;
-    ComputationPtr      m_computation;
-    foundation::AABB2i  m_displayWindow;
-    foundation::AABB2i  m_dataWindow;
+    RendererController&     m_rendererController;
+    ComputationPtr          m_computation;
+    foundation::AABB2i      m_displayWindow;
+    foundation::AABB2i      m_dataWindow;
+    RenderViewUpdaterPtr    m_updater;
 };
 
 #endif  // !APPLESEED_MAYA_RENDERVIEWTILECALLBACK_H
@@ -0,0 +1,378 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "renderviewupdater.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/idlejobqueue.h"
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/pixelkernels.h"
+#include "appleseedmaya/tracer.h"
+
+// appleseed.foundation headers.
+#include "foundation/image/pixel.h"
+#include "foundation/image/tile.h"
+#include "foundation/utility/string.h"
+
+// Standard headers.
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+namespace asf = foundation;
+
+namespace
+{
+    std::chrono::steady_clock::duration minFlushInterval()
+    {
+        double fps = 30.0;
+
+        if (const char* value = getenv("APPLESEED_MAYA_RENDER_VIEW_FPS"))
+            fps = atof(value);
+
+        if (fps <= 0.0)
+            return std::chrono::steady_clock::duration::zero();
+
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / fps));
+    }
+
+    double milliseconds(const std::chrono::steady_clock::duration& duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+RenderViewUpdater::RenderViewUpdater(
+    const asf::AABB2i&          displayWindow,
+    const asf::AABB2i&          dataWindow,
+    const size_t                tileWidth,
+    const size_t                tileHeight,
+    RendererController&         rendererController,
+    ComputationPtr              computation)
+  : m_displayWindow(displayWindow)
+  , m_dataWindow(dataWindow)
+  , m_tileWidth(tileWidth)
+  , m_tileHeight(tileHeight)
+  , m_tileCountX((displayWindow.max.x + tileWidth) / tileWidth)
+  , m_tileCountY((displayWindow.max.y + tileHeight) / tileHeight)
+  , m_width(dataWindow.max.x - dataWindow.min.x + 1)
+  , m_rendererController(rendererController)
+  , m_computation(computation)
+  , m_minFlushInterval(minFlushInterval())
+  , m_pixels(
+        PixelBufferPool::acquire(
+            m_width * (dataWindow.max.y - dataWindow.min.y + 1),
+            tileWidth * tileHeight))
+  , m_dirtyTiles(m_tileCountX * m_tileCountY, 0)
+  , m_dirtyTileCount(0)
+  , m_flushPending(false)
+  , m_finished(false)
+  , m_lastFlush(Clock::now() - m_minFlushInterval)
+  , m_measuringEditLatency(false)
+  , m_editPixelsWritten(false)
+  , m_editCount(0)
+  , m_totalEditLatency(Clock::duration::zero())
+  , m_maxEditLatency(Clock::duration::zero())
+{
+    static_assert(sizeof(RV_PIXEL) == 4 * sizeof(float), "RV_PIXEL is expected to be 4 floats");
+}
+
+void RenderViewUpdater::writeTile(
+    const asf::Tile&            tile,
+    const size_t                tileX,
+    const size_t                tileY)
+{
+    assert(tile.get_pixel_format() == asf::PixelFormatFloat);
+    assert(tile.get_channel_count() == 4);
+
+    const int x0 = static_cast<int>(tileX * m_tileWidth);
+    const int y0 = static_cast<int>(tileY * m_tileHeight);
+
+    const int xmin = std::max(m_dataWindow.min.x, x0);
+    const int ymin = std::max(m_dataWindow.min.y, y0);
+    const int xmax = std::min(m_dataWindow.max.x, x0 + static_cast<int>(tile.get_width()) - 1);
+    const int ymax = std::min(m_dataWindow.max.y, y0 + static_cast<int>(tile.get_height()) - 1);
+
+    if (xmax < xmin || ymax < ymin)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_finished)
+        return;
+
+    // Copy and flip the tile verticaly (Maya's renderview is y up).
+    PixelKernels::copyRGBAFloatFlipped(
+        reinterpret_cast<const float*>(tile.pixel(xmin - x0, ymin - y0)),
+        tile.get_width() * 4,
+        reinterpret_cast<float*>(&m_pixels[(m_dataWindow.max.y - ymax) * m_width + (xmin - m_dataWindow.min.x)]),
+        m_width * 4,
+        static_cast<size_t>(xmax - xmin + 1),
+        static_cast<size_t>(ymax - ymin + 1));
+
+    std::uint8_t& dirty = m_dirtyTiles[tileY * m_tileCountX + tileX];
+    if (!dirty)
+    {
+        dirty = 1;
+        ++m_dirtyTileCount;
+    }
+
+    if (m_measuringEditLatency)
+        m_editPixelsWritten = true;
+
+    scheduleFlush();
+}
+
+void RenderViewUpdater::flush()
+{
+    if (!flushTiles(false))
+        pushFlushJob();
+}
+
+void RenderViewUpdater::finish()
+{
+    // Send the updates held back by the rate limit.
+    flushTiles(true);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_finished = true;
+    m_pixels.reset();
+
+    if (m_editCount != 0)
+    {
+        RENDERER_LOG_INFO(
+            "Interactive edits: %s, average latency %.1f ms, maximum latency %.1f ms",
+            asf::pretty_uint(m_editCount).c_str(),
+            milliseconds(m_totalEditLatency) / m_editCount,
+            milliseconds(m_maxEditLatency));
+    }
+}
+
+void RenderViewUpdater::measureEditLatency(const Clock::time_point& editTime)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // A previous edit not displayed yet is superseded by this one.
+    m_editTime = editTime;
+    m_measuringEditLatency = true;
+    m_editPixelsWritten = false;
+}
+
+void RenderViewUpdater::scheduleFlush()
+{
+    // Updates within the minimum interval of the last one are not dropped:
+    // the pending job puts itself back in the queue until the interval has passed.
+    // If the idle job queue is full, the next tile or finish() sends the update.
+    if (m_flushPending)
+        return;
+
+    m_flushPending = pushFlushJob();
+}
+
+bool RenderViewUpdater::pushFlushJob()
+{
+    FlushJob job = {shared_from_this()};
+    return IdleJobQueue::pushJob(job);
+}
+
+bool RenderViewUpdater::flushTiles(const bool ignoreRateLimit)
+{
+    Tracer::ScopedEvent event("render", "updateRenderView");
+
+    // Only the pixels are copied while the render threads are locked out,
+    // the render view is updated after the lock is released.
+    std::vector<RenderViewUpdate> updates;
+    bool editDisplayed = false;
+    Clock::time_point editTime;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_finished)
+        {
+            m_flushPending = false;
+            return true;
+        }
+
+        if (m_computation && m_computation->isInterruptRequested())
+        {
+            m_flushPending = false;
+            m_rendererController.set_status(RendererController::AbortRendering);
+            return true;
+        }
+
+        // Keep the flush pending, the caller queues it again.
+        if (!ignoreRateLimit && m_dirtyTileCount != 0 && Clock::now() - m_lastFlush < m_minFlushInterval)
+            return false;
+
+        m_flushPending = false;
+        m_lastFlush = Clock::now();
+
+        if (m_dirtyTileCount == 0)
+            return true;
+
+        std::vector<TileRect> rects;
+        mergeDirtyTiles(rects);
+
+        updates.resize(rects.size());
+        for (size_t i = 0, e = rects.size(); i < e; ++i)
+            copyRect(rects[i], updates[i]);
+
+        std::fill(m_dirtyTiles.begin(), m_dirtyTiles.end(), 0);
+        m_dirtyTileCount = 0;
+
+        if (m_measuringEditLatency && m_editPixelsWritten)
+        {
+            editDisplayed = true;
+            editTime = m_editTime;
+            m_measuringEditLatency = false;
+        }
+    }
+
+    for (size_t i = 0, e = updates.size(); i < e; ++i)
+        updateRenderView(updates[i]);
+
+    if (editDisplayed)
+        recordEditLatency(editTime);
+
+    return true;
+}
+
+void RenderViewUpdater::mergeDirtyTiles(std::vector<TileRect>& rects) const
+{
+    // Merge horizontal runs of dirty tiles, then extend the rectangles
+    // downwards while the next row has a run with the same extent.
+    std::vector<size_t> openRects;
+    std::vector<size_t> nextOpenRects;
+
+    for (size_t ty = 0; ty < m_tileCountY; ++ty)
+    {
+        const std::uint8_t* dirty = &m_dirtyTiles[ty * m_tileCountX];
+        nextOpenRects.clear();
+
+        for (size_t tx = 0; tx < m_tileCountX; )
+        {
+            if (!dirty[tx])
+            {
+                ++tx;
+                continue;
+            }
+
+            const size_t x0 = tx;
+            while (tx < m_tileCountX && dirty[tx])
+                ++tx;
+            const size_t x1 = tx - 1;
+
+            auto it = std::find_if(
+                openRects.begin(),
+                openRects.end(),
+                [&rects, x0, x1](const size_t i) { return rects[i].m_x0 == x0 && rects[i].m_x1 == x1; });
+
+            if (it != openRects.end())
+            {
+                rects[*it].m_y1 = ty;
+                nextOpenRects.push_back(*it);
+            }
+            else
+            {
+                const TileRect rect = {x0, x1, ty, ty};
+                rects.push_back(rect);
+                nextOpenRects.push_back(rects.size() - 1);
+            }
+        }
+
+        openRects.swap(nextOpenRects);
+    }
+}
+
+void RenderViewUpdater::copyRect(const TileRect& rect, RenderViewUpdate& update) const
+{
+    int xmin = std::max(m_dataWindow.min.x, static_cast<int>(rect.m_x0 * m_tileWidth));
+    int ymin = std::max(m_dataWindow.min.y, static_cast<int>(rect.m_y0 * m_tileHeight));
+    int xmax = std::min(m_dataWindow.max.x, static_cast<int>((rect.m_x1 + 1) * m_tileWidth) - 1);
+    int ymax = std::min(m_dataWindow.max.y, static_cast<int>((rect.m_y1 + 1) * m_tileHeight) - 1);
+
+    const size_t w = static_cast<size_t>(xmax - xmin + 1);
+    const size_t h = static_cast<size_t>(ymax - ymin + 1);
+
+    // The first row of the rectangle in the frame buffer.
+    const RV_PIXEL* src = &m_pixels[(m_dataWindow.max.y - ymax) * m_width + (xmin - m_dataWindow.min.x)];
+
+    // Rectangles are made of tiles, so are buffers from the pool.
+    update.m_pixels = PixelBufferPool::acquire(w * h, m_tileWidth * m_tileHeight);
+
+    if (w == m_width)
+    {
+        // The rows of the rectangle are contiguous in the frame buffer.
+        std::memcpy(update.m_pixels.get(), src, w * h * sizeof(RV_PIXEL));
+    }
+    else
+    {
+        for (size_t j = 0; j < h; ++j)
+            std::memcpy(&update.m_pixels[j * w], src + j * m_width, w * sizeof(RV_PIXEL));
+    }
+
+    flip_pixel_interval(m_displayWindow.max.y + 1, ymin, ymax);
+
+    update.m_xmin = static_cast<unsigned int>(xmin);
+    update.m_xmax = static_cast<unsigned int>(xmax);
+    update.m_ymin = static_cast<unsigned int>(ymin);
+    update.m_ymax = static_cast<unsigned int>(ymax);
+}
+
+void RenderViewUpdater::updateRenderView(const RenderViewUpdate& update)
+{
+    MRenderView::updatePixels(
+        update.m_xmin,
+        update.m_xmax,
+        update.m_ymin,
+        update.m_ymax,
+        update.m_pixels.get(),
+        true);
+
+    MRenderView::refresh(
+        update.m_xmin,
+        update.m_xmax,
+        update.m_ymin,
+        update.m_ymax);
+}
+
+void RenderViewUpdater::recordEditLatency(const Clock::time_point& editTime)
+{
+    const Clock::duration latency = Clock::now() - editTime;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_editCount;
+    m_totalEditLatency += latency;
+    m_maxEditLatency = std::max(m_maxEditLatency, latency);
+
+    RENDERER_LOG_DEBUG("Interactive edit latency: %.1f ms", milliseconds(latency));
+}
@@ -0,0 +1,174 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_RENDERVIEWUPDATER_H
+#define APPLESEED_MAYA_RENDERVIEWUPDATER_H
+
+// appleseed-maya headers.
+#include "appleseedmaya/pixelbufferpool.h"
+#include "appleseedmaya/renderercontroller.h"
+#include "appleseedmaya/utils.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+#include "foundation/math/aabb.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MRenderView.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Forward declarations.
+namespace foundation    { class Tile; }
+
+//
+// Coalesces the tiles written by the render threads and sends them to
+// Maya's render view from the main thread.
+//
+// The tiles are copied to a pooled frame buffer and marked dirty. A single update
+// job is pending at any time; it merges adjacent dirty tiles into rectangles
+// and updates each rectangle with one MRenderView::updatePixels call. The render
+// threads are only held back while the rectangles are copied to pooled buffers.
+// Updates are limited to a maximum rate, 30 per second by default, that can be
+// set with the APPLESEED_MAYA_RENDER_VIEW_FPS environment variable (0 means no limit).
+//
+// During interactive renders, the updater also measures the latency from each
+// scene edit to the first render view update showing pixels rendered after it.
+//
+
+class RenderViewUpdater
+  : public std::enable_shared_from_this<RenderViewUpdater>
+  , public foundation::NonCopyable
+{
+  public:
+    RenderViewUpdater(
+        const foundation::AABB2i&   displayWindow,
+        const foundation::AABB2i&   dataWindow,
+        const size_t                tileWidth,
+        const size_t                tileHeight,
+        RendererController&         rendererController,
+        ComputationPtr              computation);
+
+    // Copy a tile of the frame and schedule an update. Thread safe.
+    void writeTile(
+        const foundation::Tile&     tile,
+        const size_t                tileX,
+        const size_t                tileY);
+
+    // Send the pending updates to the render view, or queue the flush
+    // again if the last update is too recent. Main thread only.
+    void flush();
+
+    // Send the last updates and stop updating the render view. Main thread only.
+    void finish();
+
+    // Measure the latency of a scene edit. Call before restarting the render
+    // with the edit applied. Main thread only.
+    void measureEditLatency(const std::chrono::steady_clock::time_point& editTime);
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct TileRect
+    {
+        size_t  m_x0;
+        size_t  m_x1;
+        size_t  m_y0;
+        size_t  m_y1;
+    };
+
+    // Rectangle of the render view, in Maya's coordinates, and a copy of its pixels.
+    struct RenderViewUpdate
+    {
+        unsigned int                    m_xmin;
+        unsigned int                    m_xmax;
+        unsigned int                    m_ymin;
+        unsigned int                    m_ymax;
+        PixelBufferPool::PixelBuffer    m_pixels;
+    };
+
+    struct FlushJob
+    {
+        std::shared_ptr<RenderViewUpdater> m_updater;
+
+        void operator()()
+        {
+            m_updater->flush();
+        }
+    };
+
+    void scheduleFlush();
+    bool pushFlushJob();
+
+    // Returns false if the update was held back by the rate limit.
+    bool flushTiles(const bool ignoreRateLimit);
+
+    void mergeDirtyTiles(std::vector<TileRect>& rects) const;
+    void copyRect(const TileRect& rect, RenderViewUpdate& update) const;
+    static void updateRenderView(const RenderViewUpdate& update);
+    void recordEditLatency(const Clock::time_point& editTime);
+
+    const foundation::AABB2i         m_displayWindow;
+    const foundation::AABB2i         m_dataWindow;
+    const size_t                     m_tileWidth;
+    const size_t                     m_tileHeight;
+    const size_t                     m_tileCountX;
+    const size_t                     m_tileCountY;
+    const size_t                     m_width;
+    RendererController&              m_rendererController;
+    ComputationPtr                   m_computation;
+    const Clock::duration            m_minFlushInterval;
+
+    std::mutex                       m_mutex;
+    PixelBufferPool::PixelBuffer     m_pixels;      // data window, Y up
+    std::vector<std::uint8_t>        m_dirtyTiles;
+    size_t                           m_dirtyTileCount;
+    bool                             m_flushPending;
+    bool                             m_finished;
+    Clock::time_point                m_lastFlush;
+
+    // Scene edit latency.
+    Clock::time_point                m_editTime;
+    bool                             m_measuringEditLatency;
+    bool                             m_editPixelsWritten;
+    size_t                           m_editCount;
+    Clock::duration                  m_totalEditLatency;
+    Clock::duration                  m_maxEditLatency;
+};
+
+#endif  // !APPLESEED_MAYA_RENDERVIEWUPDATER_H
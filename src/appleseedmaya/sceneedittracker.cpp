@@ -0,0 +1,422 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "sceneedittracker.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/idlejobqueue.h"
+#include "appleseedmaya/logger.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MDagPath.h>
+#include <maya/MDagPathArray.h>
+#include <maya/MDGMessage.h>
+#include <maya/MFnAttribute.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MNodeMessage.h>
+#include <maya/MPlug.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <cassert>
+#include <string>
+#include <utility>
+
+namespace asf = foundation;
+
+namespace
+{
+    MString attributeName(const MPlug& plug)
+    {
+        if (plug.isNull())
+            return MString();
+
+        return MFnAttribute(plug.attribute()).name();
+    }
+
+    // Return true if the plug is one of the world space matrices
+    // of a dag node, dirtied when a parent transform moves.
+    bool isWorldMatrixAttribute(const MPlug& plug)
+    {
+        const MString name = attributeName(plug);
+        return
+            name == "worldMatrix" ||
+            name == "worldInverseMatrix" ||
+            name == "parentMatrix" ||
+            name == "parentInverseMatrix";
+    }
+
+    // Return true if the plug of a transform node only affects its matrix.
+    bool isTransformAttribute(const MPlug& plug)
+    {
+        static const char* Prefixes[] =
+        {
+            "translate",
+            "rotate",           // rotate, rotatePivot, rotateAxis, rotateOrder...
+            "scale",            // scale, scalePivot...
+            "shear",
+            "matrix",
+            "inverseMatrix",
+            "xformMatrix",
+            "offsetParentMatrix",
+            "boundingBox",
+            "center"
+        };
+
+        if (isWorldMatrixAttribute(plug))
+            return true;
+
+        const std::string name = attributeName(plug).asChar();
+
+        for (size_t i = 0, e = sizeof(Prefixes) / sizeof(Prefixes[0]); i < e; ++i)
+        {
+            if (asf::starts_with(name, Prefixes[i]))
+                return true;
+        }
+
+        return false;
+    }
+
+    const MObjectHandle& nodeHandle(const MObjectHandle& node)
+    {
+        return node;
+    }
+
+    const MObjectHandle& nodeHandle(const SceneEditTracker::PlugEdits& plugEdits)
+    {
+        return plugEdits.m_node;
+    }
+
+    // Find the entry of a node in a map indexed by MObjectHandle hash codes.
+    template <typename Map>
+    typename Map::iterator findNode(Map& map, const MObjectHandle& node)
+    {
+        auto range = map.equal_range(node.hashCode());
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (nodeHandle(it->second).objectRef() == node.objectRef())
+                return it;
+        }
+
+        return map.end();
+    }
+
+    void insertNode(SceneEditTracker::NodeSet& nodes, const MObjectHandle& node)
+    {
+        if (findNode(nodes, node) == nodes.end())
+            nodes.insert(std::make_pair(node.hashCode(), node));
+    }
+}
+
+SceneEditTracker::Edits::Edits()
+  : m_renderGlobalsChanged(false)
+{
+}
+
+void SceneEditTracker::Edits::clear()
+{
+    m_dirtyDagNodes.clear();
+    m_dirtyTransforms.clear();
+    m_movedDagNodes.clear();
+    m_movedTransforms.clear();
+    m_dirtyShadingNodes.clear();
+    m_editedShadingNodes.clear();
+    m_dirtyShadingEngines.clear();
+    m_addedDagNodes.clear();
+    m_removedDagPaths.clear();
+    m_removedShadingEngines.clear();
+    m_renderGlobalsChanged = false;
+}
+
+bool SceneEditTracker::Edits::empty() const
+{
+    return
+        m_dirtyDagNodes.empty() &&
+        m_dirtyTransforms.empty() &&
+        m_movedDagNodes.empty() &&
+        m_movedTransforms.empty() &&
+        m_dirtyShadingNodes.empty() &&
+        m_editedShadingNodes.empty() &&
+        m_dirtyShadingEngines.empty() &&
+        m_addedDagNodes.empty() &&
+        m_removedDagPaths.empty() &&
+        m_removedShadingEngines.empty() &&
+        !m_renderGlobalsChanged;
+}
+
+SceneEditTracker::SceneEditTracker(ApplyEditsFun applyEdits)
+  : m_applyEdits(applyEdits)
+  , m_applyPending(false)
+{
+    MStatus status;
+
+    m_callbackIds.append(
+        MDGMessage::addNodeAddedCallback(
+            &SceneEditTracker::nodeAddedCallback,
+            "dependNode",
+            this,
+            &status));
+
+    m_callbackIds.append(
+        MDGMessage::addNodeRemovedCallback(
+            &SceneEditTracker::nodeRemovedCallback,
+            "dependNode",
+            this,
+            &status));
+
+    m_callbackIds.append(
+        MDGMessage::addConnectionCallback(
+            &SceneEditTracker::connectionCallback,
+            this,
+            &status));
+}
+
+SceneEditTracker::~SceneEditTracker()
+{
+    for (auto it = m_watchedNodes.begin(), e = m_watchedNodes.end(); it != e; ++it)
+        m_callbackIds.append(it->second.m_callbackId);
+
+    MMessage::removeCallbacks(m_callbackIds);
+}
+
+void SceneEditTracker::watchNode(const MObject& node, const NodeKind kind)
+{
+    const MObjectHandle handle(node);
+
+    if (findWatchedNode(handle) != m_watchedNodes.end())
+        return;
+
+    MStatus status;
+    MObject nonConstNode(node);
+    const MCallbackId callbackId =
+        MNodeMessage::addNodeDirtyPlugCallback(
+            nonConstNode,
+            &SceneEditTracker::nodeDirtyCallback,
+            this,
+            &status);
+
+    if (!status)
+    {
+        RENDERER_LOG_WARNING(
+            "Could not watch node %s for interactive edits",
+            MFnDependencyNode(node).name().asChar());
+        return;
+    }
+
+    WatchedNode watchedNode;
+    watchedNode.m_node = handle;
+    watchedNode.m_kind = kind;
+    watchedNode.m_callbackId = callbackId;
+    m_watchedNodes.insert(std::make_pair(handle.hashCode(), watchedNode));
+}
+
+void SceneEditTracker::takeEdits(Edits& edits)
+{
+    edits = m_edits;
+    m_edits.clear();
+    m_applyPending = false;
+}
+
+void SceneEditTracker::discardEdits()
+{
+    m_edits.clear();
+}
+
+void SceneEditTracker::nodeDirtyCallback(MObject& node, MPlug& plug, void* clientData)
+{
+    static_cast<SceneEditTracker*>(clientData)->nodeChanged(node, plug);
+}
+
+void SceneEditTracker::nodeAddedCallback(MObject& node, void* clientData)
+{
+    static_cast<SceneEditTracker*>(clientData)->nodeAdded(node);
+}
+
+void SceneEditTracker::nodeRemovedCallback(MObject& node, void* clientData)
+{
+    static_cast<SceneEditTracker*>(clientData)->nodeRemoved(node);
+}
+
+void SceneEditTracker::connectionCallback(MPlug& srcPlug, MPlug& dstPlug, bool made, void* clientData)
+{
+    SceneEditTracker* self = static_cast<SceneEditTracker*>(clientData);
+
+    // Shading networks and shading engines are watched on the destination side.
+    self->nodeChanged(dstPlug.node(), MPlug());
+
+    // Shading group assignments are connections from the shape to the shading engine.
+    const MObject srcNode = srcPlug.node();
+    auto it = self->findWatchedNode(MObjectHandle(srcNode));
+    if (it != self->m_watchedNodes.end() && it->second.m_kind == DagNode)
+        self->nodeChanged(srcNode, MPlug());
+}
+
+void SceneEditTracker::nodeChanged(const MObject& node, const MPlug& plug)
+{
+    const MObjectHandle handle(node);
+
+    auto it = findWatchedNode(handle);
+    if (it == m_watchedNodes.end())
+        return;
+
+    switch (it->second.m_kind)
+    {
+        case DagNode:
+            if (isWorldMatrixAttribute(plug))
+                insertNode(m_edits.m_movedDagNodes, handle);
+            else
+                insertNode(m_edits.m_dirtyDagNodes, handle);
+        break;
+
+        case TransformNode:
+            if (isTransformAttribute(plug))
+                insertNode(m_edits.m_movedTransforms, handle);
+            else
+                insertNode(m_edits.m_dirtyTransforms, handle);
+        break;
+
+        case ShadingNode:
+            // Connection changes update the whole shading network.
+            if (plug.isNull())
+                insertNode(m_edits.m_dirtyShadingNodes, handle);
+            else
+                shadingPlugEdited(handle, plug);
+        break;
+
+        case ShadingEngineNode:
+            insertNode(m_edits.m_dirtyShadingEngines, handle);
+        break;
+
+        case RenderGlobalsNode:
+            m_edits.m_renderGlobalsChanged = true;
+        break;
+
+        default:
+            assert(false);
+        break;
+    }
+
+    scheduleApplyEdits();
+}
+
+void SceneEditTracker::nodeAdded(const MObject& node)
+{
+    // Transforms are not exported, the shapes parented to them are added too.
+    if (!node.hasFn(MFn::kDagNode) || node.hasFn(MFn::kTransform))
+        return;
+
+    const MObjectHandle handle(node);
+    insertNode(m_edits.m_addedDagNodes, handle);
+    scheduleApplyEdits();
+}
+
+void SceneEditTracker::nodeRemoved(const MObject& node)
+{
+    auto it = findWatchedNode(MObjectHandle(node));
+    if (it == m_watchedNodes.end())
+        return;
+
+    const NodeKind kind = it->second.m_kind;
+    MMessage::removeCallback(it->second.m_callbackId);
+    m_watchedNodes.erase(it);
+
+    if (kind == DagNode || kind == TransformNode)
+    {
+        // The exporters of the node and of its children are removed.
+        MDagPathArray paths;
+        MDagPath::getAllPathsTo(node, paths);
+
+        for (unsigned int i = 0, e = paths.length(); i < e; ++i)
+            m_edits.m_removedDagPaths.push_back(paths[i].fullPathName());
+    }
+    else if (kind == ShadingEngineNode)
+        m_edits.m_removedShadingEngines.push_back(MFnDependencyNode(node).name());
+    else if (kind == ShadingNode)
+    {
+        // The networks using the node are updated when its connections are broken.
+        return;
+    }
+    else if (kind == RenderGlobalsNode)
+        m_edits.m_renderGlobalsChanged = true;
+
+    scheduleApplyEdits();
+}
+
+void SceneEditTracker::shadingPlugEdited(const MObjectHandle& node, const MPlug& plug)
+{
+    // Output plugs are dirtied when inputs change, they are not parameters.
+    if (!MFnAttribute(plug.attribute()).isWritable())
+        return;
+
+    auto it = findNode(m_edits.m_editedShadingNodes, node);
+    if (it == m_edits.m_editedShadingNodes.end())
+    {
+        PlugEdits newPlugEdits;
+        newPlugEdits.m_node = node;
+        it = m_edits.m_editedShadingNodes.insert(std::make_pair(node.hashCode(), newPlugEdits));
+    }
+
+    PlugEdits& plugEdits = it->second;
+
+    for (unsigned int i = 0, e = plugEdits.m_plugs.length(); i < e; ++i)
+    {
+        if (plugEdits.m_plugs[i] == plug)
+            return;
+    }
+
+    plugEdits.m_plugs.append(plug);
+}
+
+SceneEditTracker::WatchedNodeMap::iterator SceneEditTracker::findWatchedNode(const MObjectHandle& node)
+{
+    auto range = m_watchedNodes.equal_range(node.hashCode());
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second.m_node.objectRef() == node.objectRef())
+            return it;
+    }
+
+    return m_watchedNodes.end();
+}
+
+void SceneEditTracker::scheduleApplyEdits()
+{
+    if (!m_applyPending)
+    {
+        m_edits.m_time = std::chrono::steady_clock::now();
+        m_applyPending = true;
+        IdleJobQueue::pushJob(m_applyEdits);
+    }
+}
@@ -0,0 +1,156 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_SCENEEDITTRACKER_H
+#define APPLESEED_MAYA_SCENEEDITTRACKER_H
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MCallbackIdArray.h>
+#include <maya/MMessage.h>
+#include <maya/MObject.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MPlugArray.h>
+#include <maya/MString.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <chrono>
+#include <map>
+#include <vector>
+
+//
+// Tracks the edits made to the Maya scene during interactive renders.
+//
+// Edits are collected from Maya messages on the watched nodes and
+// the function passed to the constructor is called from an idle job
+// to apply them. Edits made before the idle job runs are merged.
+//
+
+class SceneEditTracker
+  : public foundation::NonCopyable
+{
+  public:
+    // Watched node categories.
+    enum NodeKind
+    {
+        DagNode,                // exported shapes, lights and cameras
+        TransformNode,          // parents of exported dag nodes
+        ShadingNode,            // nodes of exported shading networks
+        ShadingEngineNode,      // exported shading engines
+        RenderGlobalsNode       // appleseed render globals
+    };
+
+    // Nodes indexed by their MObjectHandle hash code. Hash codes are not
+    // unique, nodes with the same hash code are told apart by their handles.
+    typedef std::multimap<unsigned int, MObjectHandle> NodeSet;
+
+    // Edited plugs of a node.
+    struct PlugEdits
+    {
+        MObjectHandle           m_node;
+        MPlugArray              m_plugs;
+    };
+
+    // Plug edits indexed by the MObjectHandle hash code of their node.
+    typedef std::multimap<unsigned int, PlugEdits> PlugEditMap;
+
+    struct Edits
+    {
+        Edits();
+
+        void clear();
+
+        bool empty() const;
+
+        NodeSet                 m_dirtyDagNodes;
+        NodeSet                 m_dirtyTransforms;
+        NodeSet                 m_movedDagNodes;        // only the world matrix changed
+        NodeSet                 m_movedTransforms;      // only the transform attributes changed
+        NodeSet                 m_dirtyShadingNodes;    // connections changed
+        PlugEditMap             m_editedShadingNodes;   // only parameter values changed
+        NodeSet                 m_dirtyShadingEngines;
+        NodeSet                 m_addedDagNodes;
+        std::vector<MString>    m_removedDagPaths;
+        std::vector<MString>    m_removedShadingEngines;
+        bool                    m_renderGlobalsChanged;
+        std::chrono::steady_clock::time_point m_time;   // time of the first edit
+    };
+
+    typedef void (*ApplyEditsFun)();
+
+    explicit SceneEditTracker(ApplyEditsFun applyEdits);
+
+    ~SceneEditTracker();
+
+    // Watch a node for changes. Does nothing if the node is already watched.
+    void watchNode(const MObject& node, const NodeKind kind);
+
+    // Move the pending edits to edits.
+    void takeEdits(Edits& edits);
+
+    // Forget the pending edits.
+    void discardEdits();
+
+  private:
+    struct WatchedNode
+    {
+        MObjectHandle   m_node;
+        NodeKind        m_kind;
+        MCallbackId     m_callbackId;
+    };
+
+    typedef std::multimap<unsigned int, WatchedNode> WatchedNodeMap;
+
+    WatchedNodeMap::iterator findWatchedNode(const MObjectHandle& node);
+
+    static void nodeDirtyCallback(MObject& node, MPlug& plug, void* clientData);
+    static void nodeAddedCallback(MObject& node, void* clientData);
+    static void nodeRemovedCallback(MObject& node, void* clientData);
+    static void connectionCallback(MPlug& srcPlug, MPlug& dstPlug, bool made, void* clientData);
+
+    void nodeChanged(const MObject& node, const MPlug& plug);
+    void nodeAdded(const MObject& node);
+    void nodeRemoved(const MObject& node);
+    void shadingPlugEdited(const MObjectHandle& node, const MPlug& plug);
+
+    void scheduleApplyEdits();
+
+    ApplyEditsFun                           m_applyEdits;
+    MCallbackIdArray                        m_callbackIds;
+    WatchedNodeMap                          m_watchedNodes;
+    Edits                                   m_edits;
+    bool                                    m_applyPending;
+};
+
+#endif  // !APPLESEED_MAYA_SCENEEDITTRACKER_H
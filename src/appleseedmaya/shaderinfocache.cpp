@@ -0,0 +1,281 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "shaderinfocache.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/config.h"
+#include "appleseedmaya/logger.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MGlobal.h>
+#include <maya/MString.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace bfs = boost::filesystem;
+namespace asf = foundation;
+
+namespace
+{
+    const char FileMagic[4] = {'A', 'S', 'S', 'I'};
+    const std::uint32_t FileVersion = 1;
+
+    // Longer strings are considered a corruption of the file.
+    const std::uint32_t MaxStringLength = 64 * 1024;
+
+    // The shader infos depend on the code of the plugin too.
+    const char* PluginVersion = APPLESEED_MAYA_VERSION_STRING;
+
+    std::string cacheFilename()
+    {
+        std::string directory;
+
+        if (const char* value = getenv("APPLESEED_MAYA_SHADER_CACHE_DIR"))
+            directory = value;
+
+        if (directory.empty())
+        {
+            MString userAppDir;
+            if (!MGlobal::executeCommand("internalVar -userAppDir", userAppDir) || userAppDir.length() == 0)
+                return std::string();
+
+            directory = (bfs::path(userAppDir.asChar()) / "appleseed").string();
+        }
+
+        try
+        {
+            bfs::create_directories(directory);
+        }
+        catch (const bfs::filesystem_error& e)
+        {
+            RENDERER_LOG_WARNING(
+                "Could not create shader info cache directory %s: %s",
+                directory.c_str(),
+                e.what());
+            return std::string();
+        }
+
+        return (bfs::path(directory) / "oslshaderinfo.cache").string();
+    }
+
+    void writeString(std::ostream& os, const std::string& value)
+    {
+        const std::uint32_t length = static_cast<std::uint32_t>(value.size());
+        os.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        os.write(value.data(), length);
+    }
+
+    bool readString(std::istream& is, std::string& value)
+    {
+        std::uint32_t length;
+        is.read(reinterpret_cast<char*>(&length), sizeof(length));
+        if (!is || length > MaxStringLength)
+            return false;
+
+        value.resize(length);
+        is.read(&value[0], length);
+        return static_cast<bool>(is);
+    }
+}
+
+ShaderInfoCache::ShaderInfoCache()
+  : m_filename(cacheFilename())
+  , m_modified(false)
+{
+    if (!m_filename.empty())
+        load();
+}
+
+bool ShaderInfoCache::find(
+    const std::string&  path,
+    const std::uint64_t size,
+    const std::int64_t  time,
+    OSLShaderInfo&      info)
+{
+    auto it = m_entries.find(path);
+    if (it == m_entries.end() || it->second.m_size != size || it->second.m_time != time)
+        return false;
+
+    it->second.m_used = true;
+    info = it->second.m_info;
+    return true;
+}
+
+void ShaderInfoCache::insert(
+    const std::string&  path,
+    const std::uint64_t size,
+    const std::int64_t  time,
+    const OSLShaderInfo& info)
+{
+    Entry& entry = m_entries[path];
+    entry.m_size = size;
+    entry.m_time = time;
+    entry.m_info = info;
+    entry.m_used = true;
+
+    m_modified = true;
+}
+
+void ShaderInfoCache::save()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (!it->second.m_used)
+        {
+            it = m_entries.erase(it);
+            m_modified = true;
+        }
+        else
+            ++it;
+    }
+
+    if (m_filename.empty() || !m_modified)
+        return;
+
+    // Each process writes its own temporary file, Maya sessions
+    // starting at the same time may save the cache together.
+    boost::system::error_code ec;
+    const std::string tmpFilename =
+        bfs::unique_path(m_filename + ".%%%%-%%%%-%%%%.tmp", ec).string();
+    if (ec)
+        return;
+
+    bool written;
+
+    {
+        std::ofstream file(tmpFilename.c_str(), std::ios::binary);
+        file.write(FileMagic, sizeof(FileMagic));
+        file.write(reinterpret_cast<const char*>(&FileVersion), sizeof(FileVersion));
+        writeString(file, PluginVersion);
+
+        const std::uint32_t count = static_cast<std::uint32_t>(m_entries.size());
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+        for (auto it = m_entries.begin(), e = m_entries.end(); it != e; ++it)
+        {
+            writeString(file, it->first);
+            file.write(reinterpret_cast<const char*>(&it->second.m_size), sizeof(it->second.m_size));
+            file.write(reinterpret_cast<const char*>(&it->second.m_time), sizeof(it->second.m_time));
+            it->second.m_info.write(file);
+        }
+
+        file.close();
+        written = static_cast<bool>(file);
+    }
+
+    if (!written)
+    {
+        RENDERER_LOG_DEBUG("Could not write shader info cache file %s", tmpFilename.c_str());
+        bfs::remove(tmpFilename, ec);
+        return;
+    }
+
+    // Maya sessions loading the plugin at the same time never see partially written files.
+    bfs::rename(tmpFilename, m_filename, ec);
+    if (ec)
+        bfs::remove(tmpFilename, ec);
+
+    m_modified = false;
+
+    RENDERER_LOG_DEBUG(
+        "Saved %s shader infos to %s.",
+        asf::pretty_uint(m_entries.size()).c_str(),
+        m_filename.c_str());
+}
+
+void ShaderInfoCache::load()
+{
+    std::ifstream file(m_filename.c_str(), std::ios::binary);
+    if (!file)
+        return;
+
+    char magic[4];
+    std::uint32_t version;
+    std::string pluginVersion;
+    std::uint32_t count;
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+
+    if (!file ||
+        std::memcmp(magic, FileMagic, sizeof(magic)) != 0 ||
+        version != FileVersion ||
+        !readString(file, pluginVersion) ||
+        pluginVersion != PluginVersion)
+        return;
+
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file)
+        return;
+
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        std::string path;
+        Entry entry;
+        entry.m_used = false;
+
+        if (!readString(file, path))
+            break;
+
+        file.read(reinterpret_cast<char*>(&entry.m_size), sizeof(entry.m_size));
+        file.read(reinterpret_cast<char*>(&entry.m_time), sizeof(entry.m_time));
+
+        if (!file || !entry.m_info.read(file))
+            break;
+
+        m_entries[path] = entry;
+    }
+
+    // Ignore truncated or corrupted files, the cache is written again on save.
+    if (m_entries.size() != count)
+    {
+        RENDERER_LOG_DEBUG("Ignoring invalid shader info cache file %s", m_filename.c_str());
+        m_entries.clear();
+        return;
+    }
+
+    RENDERER_LOG_DEBUG(
+        "Loaded %s shader infos from %s.",
+        asf::pretty_uint(m_entries.size()).c_str(),
+        m_filename.c_str());
+}
@@ -0,0 +1,96 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_SHADERINFOCACHE_H
+#define APPLESEED_MAYA_SHADERINFOCACHE_H
+
+// appleseed-maya headers.
+#include "appleseedmaya/shadingnodemetadata.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstdint>
+#include <map>
+#include <string>
+
+//
+// Persistent cache of OSL shader infos, so that only new or modified shaders
+// are queried when the plugin is loaded.
+//
+// Shaders are indexed by path and their entries are valid as long as the size
+// and modification time of the shader file do not change. The cache is stored
+// in the directory set by the APPLESEED_MAYA_SHADER_CACHE_DIR environment
+// variable, or in the Maya user application directory by default.
+//
+
+class ShaderInfoCache
+  : public foundation::NonCopyable
+{
+  public:
+    // Load the cache file.
+    ShaderInfoCache();
+
+    // Copy the info of a shader if its cache entry is up to date.
+    // Return false if the shader has to be queried.
+    bool find(
+        const std::string&  path,
+        const std::uint64_t size,
+        const std::int64_t  time,
+        OSLShaderInfo&      info);
+
+    void insert(
+        const std::string&  path,
+        const std::uint64_t size,
+        const std::int64_t  time,
+        const OSLShaderInfo& info);
+
+    // Write the cache file if it changed. The entries of shaders that were
+    // neither found nor inserted since the cache was loaded are dropped.
+    void save();
+
+  private:
+    struct Entry
+    {
+        std::uint64_t   m_size;
+        std::int64_t    m_time;
+        OSLShaderInfo   m_info;
+        bool            m_used;
+    };
+
+    void load();
+
+    const std::string               m_filename;
+    std::map<std::string, Entry>    m_entries;
+    bool                            m_modified;
+};
+
+#endif  // !APPLESEED_MAYA_SHADERINFOCACHE_H
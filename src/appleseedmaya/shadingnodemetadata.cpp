@@ -44,12 +44,18 @@
 
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MFnDependencyNode.h>
+#include <maya/MNodeClass.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MPlug.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
+#include <cstdint>
 #include <cstdlib>
 #include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace asr = renderer;
@@ -91,6 +97,82 @@ bool OSLMetadataExtractor::getValue(const char* key, bool& value)
 
 namespace
 {
+    // Serialization helpers.
+
+    // Longer strings and arrays are considered a corruption of the data.
+    const std::uint32_t MaxSerializedStringLength = 64 * 1024;
+    const std::uint32_t MaxSerializedArraySize = 64 * 1024;
+
+    template <typename T>
+    void writeValue(std::ostream& os, const T& value)
+    {
+        os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::istream& is, T& value)
+    {
+        is.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return static_cast<bool>(is);
+    }
+
+    void writeValue(std::ostream& os, const bool value)
+    {
+        writeValue<std::uint8_t>(os, value ? 1 : 0);
+    }
+
+    bool readValue(std::istream& is, bool& value)
+    {
+        std::uint8_t tmp;
+        if (!readValue(is, tmp))
+            return false;
+
+        value = tmp != 0;
+        return true;
+    }
+
+    void writeValue(std::ostream& os, const MString& value)
+    {
+        const std::uint32_t length = value.length();
+        writeValue(os, length);
+        os.write(value.asChar(), length);
+    }
+
+    bool readValue(std::istream& is, MString& value)
+    {
+        std::uint32_t length;
+        if (!readValue(is, length) || length > MaxSerializedStringLength)
+            return false;
+
+        std::string tmp(length, '\0');
+        is.read(&tmp[0], length);
+        value = tmp.c_str();
+        return static_cast<bool>(is);
+    }
+
+    void writeValue(std::ostream& os, const std::vector<double>& value)
+    {
+        writeValue(os, static_cast<std::uint32_t>(value.size()));
+        for (size_t i = 0, e = value.size(); i < e; ++i)
+            writeValue(os, value[i]);
+    }
+
+    bool readValue(std::istream& is, std::vector<double>& value)
+    {
+        std::uint32_t size;
+        if (!readValue(is, size) || size > MaxSerializedArraySize)
+            return false;
+
+        value.resize(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (!readValue(is, value[i]))
+                return false;
+        }
+
+        return true;
+    }
+
     void getFloat3Default(const asf::Dictionary& paramInfo, std::vector<double>& defaultValue)
     {
         const asf::Vector3f v = paramInfo.get<asf::Vector3f>("default");
@@ -100,6 +182,30 @@ namespace
     }
 }
 
+OSLParamInfo::OSLParamInfo()
+  : isOutput(false)
+  , isClosure(false)
+  , isStruct(false)
+  , isArray(false)
+  , arrayLen(-1)
+  , lockGeom(true)
+  , validDefault(false)
+  , hasDefault(false)
+  , hasMin(false)
+  , minValue(0.0)
+  , hasMax(false)
+  , maxValue(0.0)
+  , hasSoftMin(false)
+  , softMinValue(0.0)
+  , hasSoftMax(false)
+  , softMaxValue(0.0)
+  , divider(false)
+  , mayaAttributeConnectable(true)
+  , mayaAttributeHidden(false)
+  , mayaAttributeKeyable(true)
+{
+}
+
 OSLParamInfo::OSLParamInfo(const asf::Dictionary& paramInfo)
   : arrayLen(-1)
   , lockGeom(true)
@@ -208,6 +314,105 @@ OSLParamInfo::OSLParamInfo(const asf::Dictionary& paramInfo)
     }
 }
 
+void OSLParamInfo::write(std::ostream& os) const
+{
+    writeValue(os, paramName);
+    writeValue(os, paramType);
+    writeValue(os, isOutput);
+    writeValue(os, isClosure);
+    writeValue(os, isStruct);
+    writeValue(os, structName);
+    writeValue(os, isArray);
+    writeValue(os, arrayLen);
+    writeValue(os, lockGeom);
+
+    writeValue(os, validDefault);
+    writeValue(os, hasDefault);
+    writeValue(os, defaultValue);
+    writeValue(os, defaultStringValue);
+
+    writeValue(os, units);
+    writeValue(os, page);
+    writeValue(os, label);
+    writeValue(os, widget);
+    writeValue(os, options);
+    writeValue(os, help);
+    writeValue(os, hasMin);
+    writeValue(os, minValue);
+    writeValue(os, hasMax);
+    writeValue(os, maxValue);
+    writeValue(os, hasSoftMin);
+    writeValue(os, softMinValue);
+    writeValue(os, hasSoftMax);
+    writeValue(os, softMaxValue);
+    writeValue(os, divider);
+
+    writeValue(os, asWidget);
+
+    writeValue(os, mayaAttributeName);
+    writeValue(os, mayaAttributeShortName);
+    writeValue(os, mayaAttributeConnectable);
+    writeValue(os, mayaAttributeHidden);
+    writeValue(os, mayaAttributeKeyable);
+}
+
+bool OSLParamInfo::read(std::istream& is)
+{
+    return
+        readValue(is, paramName) &&
+        readValue(is, paramType) &&
+        readValue(is, isOutput) &&
+        readValue(is, isClosure) &&
+        readValue(is, isStruct) &&
+        readValue(is, structName) &&
+        readValue(is, isArray) &&
+        readValue(is, arrayLen) &&
+        readValue(is, lockGeom) &&
+
+        readValue(is, validDefault) &&
+        readValue(is, hasDefault) &&
+        readValue(is, defaultValue) &&
+        readValue(is, defaultStringValue) &&
+
+        readValue(is, units) &&
+        readValue(is, page) &&
+        readValue(is, label) &&
+        readValue(is, widget) &&
+        readValue(is, options) &&
+        readValue(is, help) &&
+        readValue(is, hasMin) &&
+        readValue(is, minValue) &&
+        readValue(is, hasMax) &&
+        readValue(is, maxValue) &&
+        readValue(is, hasSoftMin) &&
+        readValue(is, softMinValue) &&
+        readValue(is, hasSoftMax) &&
+        readValue(is, softMaxValue) &&
+        readValue(is, divider) &&
+
+        readValue(is, asWidget) &&
+
+        readValue(is, mayaAttributeName) &&
+        readValue(is, mayaAttributeShortName) &&
+        readValue(is, mayaAttributeConnectable) &&
+        readValue(is, mayaAttributeHidden) &&
+        readValue(is, mayaAttributeKeyable);
+}
+
+MPlug OSLParamInfo::findPlug(const MFnDependencyNode& depNodeFn, MStatus* status) const
+{
+    if (!mayaAttribute.isNull())
+    {
+        if (status)
+            *status = MS::kSuccess;
+
+        return MPlug(depNodeFn.object(), mayaAttribute);
+    }
+
+    // Dynamic attributes are not known when the shader is registered.
+    return depNodeFn.findPlug(mayaAttributeName, false, status);
+}
+
 std::ostream& operator<<(std::ostream& os, const OSLParamInfo& paramInfo)
 {
     os << "Param : " << paramInfo.paramName << "\n";
@@ -259,8 +464,78 @@ OSLShaderInfo::OSLShaderInfo(
         mayaName = shaderName;
 }
 
+void OSLShaderInfo::write(std::ostream& os) const
+{
+    writeValue(os, shaderName);
+    writeValue(os, shaderType);
+    writeValue(os, shaderFileName);
+    writeValue(os, shaderHelpURL);
+
+    writeValue(os, mayaName);
+    writeValue(os, mayaClassification);
+    writeValue(os, typeId);
+
+    writeValue(os, static_cast<std::uint32_t>(paramInfo.size()));
+    for (size_t i = 0, e = paramInfo.size(); i < e; ++i)
+        paramInfo[i].write(os);
+}
+
+bool OSLShaderInfo::read(std::istream& is)
+{
+    std::uint32_t paramCount;
+
+    if (!readValue(is, shaderName) ||
+        !readValue(is, shaderType) ||
+        !readValue(is, shaderFileName) ||
+        !readValue(is, shaderHelpURL) ||
+        !readValue(is, mayaName) ||
+        !readValue(is, mayaClassification) ||
+        !readValue(is, typeId) ||
+        !readValue(is, paramCount) ||
+        paramCount > MaxSerializedArraySize)
+        return false;
+
+    paramInfo.resize(paramCount);
+    for (size_t i = 0; i < paramCount; ++i)
+    {
+        if (!paramInfo[i].read(is))
+            return false;
+    }
+
+    return true;
+}
+
+void OSLShaderInfo::findMayaAttributes()
+{
+    m_paramNameIndex.clear();
+    m_paramAttributeIndex.clear();
+
+    MNodeClass nodeClass(mayaName);
+
+    for (size_t i = 0, e = paramInfo.size(); i < e; ++i)
+    {
+        OSLParamInfo& p = paramInfo[i];
+        m_paramNameIndex.insert(std::make_pair(p.mayaAttributeName, i));
+
+        MStatus status;
+        p.mayaAttribute = nodeClass.attribute(p.mayaAttributeName, &status);
+
+        if (!status)
+            p.mayaAttribute = MObject::kNullObj;
+        else
+            m_paramAttributeIndex.insert(std::make_pair(MObjectHandle(p.mayaAttribute).hashCode(), i));
+    }
+}
+
 const OSLParamInfo* OSLShaderInfo::findParam(const MString& mayaAttrName) const
 {
+    if (!m_paramNameIndex.empty())
+    {
+        auto it = m_paramNameIndex.find(mayaAttrName);
+        return it != m_paramNameIndex.end() ? &paramInfo[it->second] : nullptr;
+    }
+
+    // The parameters are not indexed until the shader is registered.
     for (size_t i = 0, e = paramInfo.size(); i < e; ++i)
     {
         if (paramInfo[i].mayaAttributeName == mayaAttrName)
@@ -272,6 +547,12 @@ const OSLParamInfo* OSLShaderInfo::findParam(const MString& mayaAttrName) const
 
 const OSLParamInfo* OSLShaderInfo::findParam(const MPlug& plug) const
 {
+    // Look for the attribute of the plug first, to avoid building its name.
+    const MObject attribute = plug.attribute();
+    auto it = m_paramAttributeIndex.find(MObjectHandle(attribute).hashCode());
+    if (it != m_paramAttributeIndex.end() && paramInfo[it->second].mayaAttribute == attribute)
+        return &paramInfo[it->second];
+
     MStatus status;
     const MString attrName =
         plug.partialName(
@@ -41,16 +41,19 @@
 
 // Maya headers.
 #include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MObject.h>
 #include <maya/MPlug.h>
 #include <maya/MString.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 // Forward declarations.
 namespace renderer { class ShaderQuery; }
+class MFnDependencyNode;
 
 //
 // The OSLMetadataExtractor class extracts OSL metadata entries from appleseed dictionaries.
@@ -92,8 +95,17 @@ class OSLMetadataExtractor
 class OSLParamInfo
 {
   public:
+    OSLParamInfo();
+
     explicit OSLParamInfo(const foundation::Dictionary& paramInfo);
 
+    // Binary serialization, used by the shader info cache.
+    void write(std::ostream& os) const;
+    bool read(std::istream& is);
+
+    // Return the plug of this parameter, using the attribute found at registration if possible.
+    MPlug findPlug(const MFnDependencyNode& depNodeFn, MStatus* status) const;
+
     // Query info.
     MString paramName;
     MString paramType;
@@ -137,6 +149,10 @@ class OSLParamInfo
     bool mayaAttributeConnectable;
     bool mayaAttributeHidden;
     bool mayaAttributeKeyable;
+
+    // Attribute of the Maya node type, found when the shader is registered.
+    // Null if the node type has no attribute of that name.
+    MObject mayaAttribute;
 };
 
 std::ostream& operator<<(std::ostream& os, const OSLParamInfo& paramInfo);
@@ -154,11 +170,19 @@ class OSLShaderInfo
         const renderer::ShaderQuery&    q,
         const MString&                  filename);
 
+    // Find the attributes of the Maya node type and index the parameters.
+    // Called once the node type is registered.
+    void findMayaAttributes();
+
     // Returns a pointer to an OSLParamInfo for a shader parameter.
     // If the parameter is not found, returns a null pointer.
     const OSLParamInfo* findParam(const MString& mayaAttrName) const;
     const OSLParamInfo* findParam(const MPlug& plug) const;
 
+    // Binary serialization, used by the shader info cache.
+    void write(std::ostream& os) const;
+    bool read(std::istream& is);
+
     // Shader info.
     MString shaderName;
     MString shaderType;
@@ -172,6 +196,14 @@ class OSLShaderInfo
 
     // Parameter information.
     std::vector<OSLParamInfo> paramInfo;
+
+  private:
+    typedef std::unordered_map<MString, size_t, MStringHash, MStringEqual> ParamNameIndex;
+    typedef std::unordered_map<unsigned int, size_t> ParamAttributeIndex;
+
+    // Parameter indices by Maya attribute name and by attribute hash code.
+    ParamNameIndex      m_paramNameIndex;
+    ParamAttributeIndex m_paramAttributeIndex;
 };
 
 #endif  // !APPLESEED_MAYA_SHADINGNODEMETADATA_H
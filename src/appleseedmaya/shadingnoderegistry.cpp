@@ -31,9 +31,12 @@
 
 // appleseed-maya headers.
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/parallel.h"
+#include "appleseedmaya/shaderinfocache.h"
 #include "appleseedmaya/shadingnode.h"
 #include "appleseedmaya/shadingnodemetadata.h"
 #include "appleseedmaya/shadingnodetemplatebuilder.h"
+#include "appleseedmaya/startupstatistics.h"
 #include "appleseedmaya/utils.h"
 
 // Build options header.
@@ -66,6 +69,7 @@
 #include "boost/filesystem.hpp"
 
 // Standard headers.
+#include <cstdint>
 #include <cstdlib>
 #include <map>
 #include <string>
@@ -120,128 +124,148 @@ namespace
     typedef std::map<MString, OSLShaderInfo, MStringCompareLess> OSLShaderInfoMap;
     OSLShaderInfoMap gShadersInfo;
 
-    bool doRegisterShader(
-        const bfs::path&    shaderPath,
-        MFnPlugin&          pluginFn,
-        asr::ShaderQuery&   query)
+    struct ShaderFile
     {
-        if (query.open(shaderPath.string().c_str()))
+        bfs::path       m_path;
+        std::uint64_t   m_size;
+        std::int64_t    m_time;
+        bool            m_valid;    // true if m_info holds the info of the shader
+        OSLShaderInfo   m_info;
+    };
+
+    bool doQueryShader(ShaderFile& shader)
+    {
+        asf::auto_release_ptr<asr::ShaderQuery> query =
+            asr::ShaderQueryFactory::create();
+
+        if (!query->open(shader.m_path.string().c_str()))
+            return false;
+
+        // Get the shader filename without the .oso extension.
+        const MString shaderFilename(shader.m_path.filename().replace_extension().c_str());
+        shader.m_info = OSLShaderInfo(*query, shaderFilename);
+        return true;
+    }
+
+    // Called from the shader query threads.
+    void queryShader(ShaderFile& shader)
+    {
+        shader.m_valid = false;
+
+        try
+        {
+            shader.m_valid = doQueryShader(shader);
+        }
+        catch (const asf::StringException& e)
+        {
+            RENDERER_LOG_ERROR(
+                "OSL shader query for shader %s failed, error = %s.",
+                shader.m_path.string().c_str(),
+                e.string());
+        }
+        catch (const std::exception& e)
+        {
+            RENDERER_LOG_ERROR(
+                "OSL shader query for shader %s failed, error = %s.",
+                shader.m_path.string().c_str(),
+                e.what());
+        }
+        catch (...)
+        {
+            RENDERER_LOG_ERROR(
+                "OSL shader query for shader %s failed.",
+                shader.m_path.string().c_str());
+        }
+    }
+
+    bool registerShader(
+        const OSLShaderInfo&    shaderInfo,
+        MFnPlugin&              pluginFn)
+    {
+        if (shaderInfo.mayaName.length() == 0)
         {
-            // Get the shader filename without the .oso extension.
-            const MString shaderFilename(shaderPath.filename().replace_extension().c_str());
-            OSLShaderInfo shaderInfo(query, shaderFilename);
+            RENDERER_LOG_DEBUG(
+                "Skipping registration for OSL shader %s. No maya name metadata found.",
+                shaderInfo.shaderName.asChar());
+            return false;
+        }
 
-            if (shaderInfo.mayaName.length() == 0)
-            {
-                RENDERER_LOG_DEBUG(
-                    "Skipping registration for OSL shader %s. No maya name metadata found.",
-                    shaderInfo.shaderName.asChar());
-                return false;
-            }
+        if (gShadersInfo.count(shaderInfo.mayaName) != 0)
+        {
+            RENDERER_LOG_DEBUG(
+                "Skipping registration for OSL shader %s. Already registered.",
+                shaderInfo.shaderName.asChar());
+            return false;
+        }
 
-            if (gShadersInfo.count(shaderInfo.mayaName) != 0)
+        if (shaderInfo.typeId != 0)
+        {
+            if (shaderInfo.mayaClassification.length() == 0)
             {
                 RENDERER_LOG_DEBUG(
-                    "Skipping registration for OSL shader %s. Already registered.",
+                    "Skipping registration for OSL shader %s. No maya classification metadata found.",
                     shaderInfo.shaderName.asChar());
                 return false;
             }
+        }
 
-            if (shaderInfo.typeId != 0)
-            {
-                if (shaderInfo.mayaClassification.length() == 0)
-                {
-                    RENDERER_LOG_DEBUG(
-                        "Skipping registration for OSL shader %s. No maya classification metadata found.",
-                        shaderInfo.shaderName.asChar());
-                    return false;
-                }
-            }
+        RENDERER_LOG_DEBUG(
+            "Registered OSL shader %s",
+            shaderInfo.shaderName.asChar());
 
+        #if 0
+            logShader(shaderInfo);
+        #endif
+
+        gShadersInfo[shaderInfo.mayaName] = shaderInfo;
+
+        if (shaderInfo.typeId != 0)
+        {
+            // This shader is not a builtin node or a node from other plugin.
+            // Create a MPxNode for this shader.
             RENDERER_LOG_DEBUG(
-                "Registered OSL shader %s",
+                "Registering MPxNode for OSL shader %s.",
                 shaderInfo.shaderName.asChar());
 
-            #if 0
-                logShader(shaderInfo);
-            #endif
-
-            gShadersInfo[shaderInfo.mayaName] = shaderInfo;
+            MStatus status;
 
-            if (shaderInfo.typeId != 0)
             {
-                // This shader is not a builtin node or a node from other plugin.
-                // Create a MPxNode for this shader.
-                RENDERER_LOG_DEBUG(
-                    "Registering MPxNode for OSL shader %s.",
-                    shaderInfo.shaderName.asChar());
+                StartupStatistics::ScopedStep step("nodeRegistration");
 
                 ShadingNode::setCurrentShaderInfo(&shaderInfo);
-                MStatus status = pluginFn.registerNode(
+                status = pluginFn.registerNode(
                     shaderInfo.mayaName,
                     MTypeId(shaderInfo.typeId),
                     &ShadingNode::creator,
                     &ShadingNode::initialize,
                     MPxNode::kDependNode,
                     &shaderInfo.mayaClassification);
+            }
 
-                if (!status)
-                {
-                    RENDERER_LOG_WARNING(
-                        "Registration of OSL shader %s failed, error = %s.",
-                        shaderInfo.shaderName.asChar(),
-                        status.errorString().asChar());
-
-                    gShadersInfo.erase(shaderInfo.mayaName);
-                    return false;
-                }
+            if (!status)
+            {
+                RENDERER_LOG_WARNING(
+                    "Registration of OSL shader %s failed, error = %s.",
+                    shaderInfo.shaderName.asChar(),
+                    status.errorString().asChar());
 
-                buildAndRegisterAETemplate(shaderInfo);
+                gShadersInfo.erase(shaderInfo.mayaName);
+                return false;
             }
 
-            return true;
+            StartupStatistics::ScopedStep step("templateBuilding");
+            buildAndRegisterAETemplate(shaderInfo);
         }
 
-        return false;
-    }
-
-    bool registerShader(
-        const bfs::path&    shaderPath,
-        MFnPlugin&          pluginFn,
-        asr::ShaderQuery&   query)
-    {
-        try
-        {
-            return doRegisterShader(shaderPath, pluginFn, query);
-        }
-        catch (const asf::StringException& e)
-        {
-            RENDERER_LOG_ERROR(
-                "OSL shader query for shader %s failed, error = %s.",
-                shaderPath.string().c_str(),
-                e.string());
-        }
-        catch (const std::exception& e)
-        {
-            RENDERER_LOG_ERROR(
-                "OSL shader query for shader %s failed, error = %s.",
-                shaderPath.string().c_str(),
-                e.what());
-        }
-        catch (...)
-        {
-            RENDERER_LOG_ERROR(
-                "OSL shader query for shader %s failed.",
-                shaderPath.string().c_str());
-        }
+        // The node type exists now, find its attributes once for all the exporters.
+        gShadersInfo[shaderInfo.mayaName].findMayaAttributes();
 
-        return false;
+        return true;
     }
 
-    void registerShadersInDirectory(
-        const bfs::path&    shaderDir,
-        MFnPlugin&          pluginFn,
-        asr::ShaderQuery&   query)
+    void findShadersInDirectory(
+        const bfs::path&            shaderDir,
+        std::vector<ShaderFile>&    shaders)
     {
         try
         {
@@ -259,7 +283,12 @@ namespace
                                 "Found OSL shader %s.",
                                 shaderPath.string().c_str());
 
-                            registerShader(shaderPath, pluginFn, query);
+                            ShaderFile shader;
+                            shader.m_path = shaderPath;
+                            shader.m_size = bfs::file_size(shaderPath);
+                            shader.m_time = bfs::last_write_time(shaderPath);
+                            shader.m_valid = false;
+                            shaders.push_back(shader);
                         }
                     }
 
@@ -307,8 +336,7 @@ MStatus registerShadingNodes(MObject plugin)
             shaderPaths.push_back(bfs::path(paths[i]));
     }
 
-    asf::auto_release_ptr<asr::ShaderQuery> query =
-        asr::ShaderQueryFactory::create();
+    std::vector<ShaderFile> shaders;
 
     // Iterate in reverse order to allow overriding of shaders.
     for (int i = static_cast<int>(shaderPaths.size()) - 1; i >= 0; --i)
@@ -317,7 +345,53 @@ MStatus registerShadingNodes(MObject plugin)
             "Looking for OSL shaders in path %s.",
             shaderPaths[i].string().c_str());
 
-        registerShadersInDirectory(shaderPaths[i], pluginFn, *query);
+        findShadersInDirectory(shaderPaths[i], shaders);
+    }
+
+    {
+        StartupStatistics::ScopedStep step("oslQuery");
+
+        // Only query the shaders that are not in the cache or were modified.
+        ShaderInfoCache cache;
+        std::vector<size_t> queries;
+
+        for (size_t i = 0, e = shaders.size(); i < e; ++i)
+        {
+            ShaderFile& shader = shaders[i];
+            shader.m_valid = cache.find(shader.m_path.string(), shader.m_size, shader.m_time, shader.m_info);
+
+            if (!shader.m_valid)
+                queries.push_back(i);
+        }
+
+        Parallel::parallelFor(
+            queries.size(),
+            [&shaders, &queries](const size_t i)
+            {
+                queryShader(shaders[queries[i]]);
+            });
+
+        for (size_t i = 0, e = queries.size(); i < e; ++i)
+        {
+            const ShaderFile& shader = shaders[queries[i]];
+
+            if (shader.m_valid)
+                cache.insert(shader.m_path.string(), shader.m_size, shader.m_time, shader.m_info);
+        }
+
+        cache.save();
+
+        RENDERER_LOG_DEBUG(
+            "Found %s OSL shaders, queried %s.",
+            asf::pretty_uint(shaders.size()).c_str(),
+            asf::pretty_uint(queries.size()).c_str());
+    }
+
+    // Maya nodes are registered from the main thread.
+    for (size_t i = 0, e = shaders.size(); i < e; ++i)
+    {
+        if (shaders[i].m_valid)
+            registerShader(shaders[i].m_info, pluginFn);
     }
 
     // Refresh the hypershade window.
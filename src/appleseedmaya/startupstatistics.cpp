@@ -0,0 +1,103 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "startupstatistics.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/exportstatistics.h"
+#include "appleseedmaya/logger.h"
+
+// Standard headers.
+#include <cstring>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Steps in the order they were first recorded.
+    std::vector<std::pair<const char*, double>> g_steps;
+    double                                      g_totalSeconds = 0.0;
+}
+
+namespace StartupStatistics
+{
+
+void addStepTime(const char* step, const double seconds)
+{
+    for (size_t i = 0, e = g_steps.size(); i < e; ++i)
+    {
+        if (strcmp(g_steps[i].first, step) == 0)
+        {
+            g_steps[i].second += seconds;
+            return;
+        }
+    }
+
+    g_steps.push_back(std::make_pair(step, seconds));
+}
+
+void finish(const double seconds)
+{
+    g_totalSeconds = seconds;
+
+    RENDERER_LOG_INFO("Plugin initialized in %f s.", seconds);
+
+    for (size_t i = 0, e = g_steps.size(); i < e; ++i)
+        RENDERER_LOG_INFO("  %s: %f s.", g_steps[i].first, g_steps[i].second);
+}
+
+std::string toJSON()
+{
+    std::stringstream ss;
+
+    ss << "{\"totalTime\": " << g_totalSeconds;
+    ss << ", \"steps\": {";
+
+    for (size_t i = 0, e = g_steps.size(); i < e; ++i)
+    {
+        ss << (i == 0 ? "" : ", ");
+        ss << "\"" << g_steps[i].first << "\": " << g_steps[i].second;
+    }
+
+    ss << "}}";
+    return ss.str();
+}
+
+ScopedStep::ScopedStep(const char* step)
+  : m_step(step)
+  , m_start(std::chrono::steady_clock::now())
+{
+}
+
+ScopedStep::~ScopedStep()
+{
+    addStepTime(m_step, ExportStatistics::secondsSince(m_start));
+}
+
+} // StartupStatistics
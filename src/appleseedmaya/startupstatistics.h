@@ -0,0 +1,75 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_STARTUPSTATISTICS_H
+#define APPLESEED_MAYA_STARTUPSTATISTICS_H
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <chrono>
+#include <string>
+
+//
+// Time spent in the steps of the plugin initialization.
+//
+
+namespace StartupStatistics
+{
+
+// Accumulate the time spent in a step of the initialization.
+void addStepTime(const char* step, const double seconds);
+
+// Record the total plugin initialization time and log the steps.
+void finish(const double seconds);
+
+// Return the steps timings as JSON, returned by the appleseedStartupStats command.
+std::string toJSON();
+
+//
+// Measure the time spent in a scope and add it to a step.
+//
+
+class ScopedStep
+  : public foundation::NonCopyable
+{
+  public:
+    explicit ScopedStep(const char* step);
+    ~ScopedStep();
+
+  private:
+    const char*                             m_step;
+    std::chrono::steady_clock::time_point   m_start;
+};
+
+} // StartupStatistics
+
+#endif  // !APPLESEED_MAYA_STARTUPSTATISTICS_H
@@ -0,0 +1,110 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "statscommands.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/exportstatistics.h"
+#include "appleseedmaya/idlejobqueue.h"
+#include "appleseedmaya/startupstatistics.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MSyntax.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <sstream>
+
+MString ExportStatsCommand::cmdName("appleseedExportStats");
+
+MSyntax ExportStatsCommand::syntaxCreator()
+{
+    MSyntax syntax;
+    return syntax;
+}
+
+void* ExportStatsCommand::creator()
+{
+    return new ExportStatsCommand();
+}
+
+MStatus ExportStatsCommand::doIt(const MArgList& args)
+{
+    setResult(ExportStatisticsReport::lastReport().c_str());
+    return MS::kSuccess;
+}
+
+MString IdleJobQueueStatsCommand::cmdName("appleseedIdleJobQueueStats");
+
+MSyntax IdleJobQueueStatsCommand::syntaxCreator()
+{
+    MSyntax syntax;
+    return syntax;
+}
+
+void* IdleJobQueueStatsCommand::creator()
+{
+    return new IdleJobQueueStatsCommand();
+}
+
+MStatus IdleJobQueueStatsCommand::doIt(const MArgList& args)
+{
+    const IdleJobQueue::Statistics stats = IdleJobQueue::statistics();
+
+    std::ostringstream ss;
+    ss << "{\"queueDepth\": " << stats.m_queueDepth;
+    ss << ", \"maxQueueDepth\": " << stats.m_maxQueueDepth;
+    ss << ", \"executedJobs\": " << stats.m_executedJobs;
+    ss << ", \"budgetExceeded\": " << stats.m_budgetExceeded;
+    ss << ", \"droppedJobs\": " << stats.m_droppedJobs;
+    ss << ", \"averageLatency\": " << stats.m_averageLatency;
+    ss << ", \"maxLatency\": " << stats.m_maxLatency << "}";
+
+    setResult(ss.str().c_str());
+    return MS::kSuccess;
+}
+
+MString StartupStatsCommand::cmdName("appleseedStartupStats");
+
+MSyntax StartupStatsCommand::syntaxCreator()
+{
+    MSyntax syntax;
+    return syntax;
+}
+
+void* StartupStatsCommand::creator()
+{
+    return new StartupStatsCommand();
+}
+
+MStatus StartupStatsCommand::doIt(const MArgList& args)
+{
+    setResult(StartupStatistics::toJSON().c_str());
+    return MS::kSuccess;
+}
@@ -0,0 +1,75 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_STATSCOMMANDS_H
+#define APPLESEED_MAYA_STATSCOMMANDS_H
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MPxCommand.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Return the JSON report of the last scene export.
+class ExportStatsCommand
+  : public MPxCommand
+{
+  public:
+    static MString cmdName;
+
+    static MSyntax syntaxCreator();
+    static void* creator();
+
+    MStatus doIt(const MArgList& args) override;
+};
+
+// Return the counters of the idle job queue as JSON.
+class IdleJobQueueStatsCommand
+  : public MPxCommand
+{
+  public:
+    static MString cmdName;
+
+    static MSyntax syntaxCreator();
+    static void* creator();
+
+    MStatus doIt(const MArgList& args) override;
+};
+
+// Return the time spent in the steps of the plugin initialization as JSON.
+class StartupStatsCommand
+  : public MPxCommand
+{
+  public:
+    static MString cmdName;
+
+    static MSyntax syntaxCreator();
+    static void* creator();
+
+    MStatus doIt(const MArgList& args) override;
+};
+
+#endif  // !APPLESEED_MAYA_STATSCOMMANDS_H
@@ -0,0 +1,329 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "swatchcache.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/exporters/shadingnetworkexporter.h"
+#include "appleseedmaya/logger.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.renderer headers.
+#include "renderer/api/shadergroup.h"
+
+// appleseed.foundation headers.
+#include "foundation/utility/string.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MImage.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Boost headers.
+#include "boost/filesystem.hpp"
+
+// Standard headers.
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+
+namespace bfs = boost::filesystem;
+namespace asf = foundation;
+namespace asr = renderer;
+
+namespace
+{
+    const char FileMagic[4] = {'A', 'S', 'W', 'C'};
+    const std::uint32_t FileVersion = 1;
+    const unsigned int MaxFileResolution = 4096;
+
+    size_t maxCacheSize()
+    {
+        size_t megabytes = 64;
+
+        if (const char* value = getenv("APPLESEED_MAYA_SWATCH_CACHE_SIZE"))
+            megabytes = static_cast<size_t>(std::max(atoi(value), 0));
+
+        return megabytes * 1024 * 1024;
+    }
+
+    std::string cacheDirectory()
+    {
+        const char* value = getenv("APPLESEED_MAYA_SWATCH_CACHE_DIR");
+        if (value == nullptr || *value == '\0')
+            return std::string();
+
+        try
+        {
+            bfs::create_directories(value);
+        }
+        catch (const bfs::filesystem_error& e)
+        {
+            RENDERER_LOG_WARNING(
+                "Could not create swatch cache directory %s: %s",
+                value,
+                e.what());
+            return std::string();
+        }
+
+        return value;
+    }
+
+    // Texture files are referenced by name in the shader parameters,
+    // hash their modification time and size to notice when they change.
+    void hashTextureFiles(const asr::ParamArray& params, MurmurHash& hash)
+    {
+        const asf::StringDictionary& strings = params.strings();
+
+        for (auto it = strings.begin(), e = strings.end(); it != e; ++it)
+        {
+            const char* value = it.value();
+            if (!asf::starts_with(value, "string "))
+                continue;
+
+            const bfs::path path(value + 7);
+
+            boost::system::error_code ec;
+            if (!bfs::is_regular_file(path, ec))
+                continue;
+
+            const std::time_t time = bfs::last_write_time(path, ec);
+            const boost::uintmax_t size = bfs::file_size(path, ec);
+
+            if (!ec)
+            {
+                hash.append(time);
+                hash.append(size);
+            }
+        }
+    }
+}
+
+SwatchCache::SwatchCache()
+  : m_maxSize(maxCacheSize())
+  , m_directory(cacheDirectory())
+  , m_size(0)
+  , m_hits(0)
+  , m_misses(0)
+{
+}
+
+void SwatchCache::hashShaderGroup(const asr::ShaderGroup& shaderGroup, MurmurHash& hash)
+{
+    ShadingNetworkExporter::hashShaderGroup(shaderGroup, hash);
+
+    const asr::ShaderContainer& shaders = shaderGroup.shaders();
+    for (auto it = shaders.begin(), e = shaders.end(); it != e; ++it)
+        hashTextureFiles(it->get_parameters(), hash);
+}
+
+bool SwatchCache::find(const MurmurHash& key, MImage& image)
+{
+    if (m_maxSize == 0)
+        return false;
+
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        // Make the entry the most recently used.
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+    }
+    else
+    {
+        Entry entry;
+        if (!readFile(key, entry))
+        {
+            ++m_misses;
+            return false;
+        }
+
+        insertEntry(entry);
+    }
+
+    const Entry& entry = m_entries.front();
+
+    unsigned int width, height;
+    image.getSize(width, height);
+
+    if (entry.m_width != width || entry.m_height != height)
+    {
+        ++m_misses;
+        return false;
+    }
+
+    std::memcpy(image.pixels(), entry.m_pixels.data(), entry.m_pixels.size());
+    ++m_hits;
+    return true;
+}
+
+void SwatchCache::insert(const MurmurHash& key, const MImage& image)
+{
+    if (m_maxSize == 0)
+        return;
+
+    Entry entry;
+    entry.m_key = key;
+    image.getSize(entry.m_width, entry.m_height);
+
+    const std::uint8_t* pixels = const_cast<MImage&>(image).pixels();
+    entry.m_pixels.assign(pixels, pixels + entry.m_width * entry.m_height * 4);
+
+    if (!m_directory.empty())
+        writeFile(entry);
+
+    insertEntry(entry);
+}
+
+void SwatchCache::clear()
+{
+    if (m_hits + m_misses != 0)
+    {
+        RENDERER_LOG_DEBUG(
+            "Swatch cache: %s hits, %s misses",
+            asf::pretty_uint(m_hits).c_str(),
+            asf::pretty_uint(m_misses).c_str());
+    }
+
+    m_entries.clear();
+    m_index.clear();
+    m_size = 0;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+bool SwatchCache::readFile(const MurmurHash& key, Entry& entry) const
+{
+    if (m_directory.empty())
+        return false;
+
+    std::ifstream file(filePath(key).c_str(), std::ios::binary);
+    if (!file)
+        return false;
+
+    char magic[4];
+    std::uint32_t version;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&entry.m_width), sizeof(entry.m_width));
+    file.read(reinterpret_cast<char*>(&entry.m_height), sizeof(entry.m_height));
+
+    if (!file ||
+        std::memcmp(magic, FileMagic, sizeof(magic)) != 0 ||
+        version != FileVersion ||
+        entry.m_width > MaxFileResolution ||
+        entry.m_height > MaxFileResolution)
+        return false;
+
+    entry.m_key = key;
+    entry.m_pixels.resize(entry.m_width * entry.m_height * 4);
+    file.read(reinterpret_cast<char*>(entry.m_pixels.data()), entry.m_pixels.size());
+
+    return static_cast<bool>(file);
+}
+
+void SwatchCache::writeFile(const Entry& entry) const
+{
+    const std::string path = filePath(entry.m_key);
+
+    // Each process writes its own temporary file, Maya sessions
+    // sharing the cache directory may cache the same swatch together.
+    boost::system::error_code ec;
+    const std::string tmpPath = bfs::unique_path(path + ".%%%%-%%%%-%%%%.tmp", ec).string();
+    if (ec)
+        return;
+
+    bool written;
+
+    {
+        std::ofstream file(tmpPath.c_str(), std::ios::binary);
+        file.write(FileMagic, sizeof(FileMagic));
+        file.write(reinterpret_cast<const char*>(&FileVersion), sizeof(FileVersion));
+        file.write(reinterpret_cast<const char*>(&entry.m_width), sizeof(entry.m_width));
+        file.write(reinterpret_cast<const char*>(&entry.m_height), sizeof(entry.m_height));
+        file.write(reinterpret_cast<const char*>(entry.m_pixels.data()), entry.m_pixels.size());
+
+        file.close();
+        written = static_cast<bool>(file);
+    }
+
+    if (!written)
+    {
+        RENDERER_LOG_DEBUG("Could not write swatch cache file %s", tmpPath.c_str());
+        bfs::remove(tmpPath, ec);
+        return;
+    }
+
+    // Other Maya sessions never see partially written files.
+    bfs::rename(tmpPath, path, ec);
+    if (ec)
+        bfs::remove(tmpPath, ec);
+}
+
+std::string SwatchCache::filePath(const MurmurHash& key) const
+{
+    return (bfs::path(m_directory) / (key.toString() + ".swatch")).string();
+}
+
+void SwatchCache::insertEntry(Entry& entry)
+{
+    auto it = m_index.find(entry.m_key);
+    if (it != m_index.end())
+    {
+        m_size -= it->second->m_pixels.size();
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    m_entries.push_front(Entry());
+    Entry& newEntry = m_entries.front();
+    newEntry.m_key = entry.m_key;
+    newEntry.m_width = entry.m_width;
+    newEntry.m_height = entry.m_height;
+    newEntry.m_pixels.swap(entry.m_pixels);
+
+    m_index[newEntry.m_key] = m_entries.begin();
+    m_size += newEntry.m_pixels.size();
+
+    evict();
+}
+
+void SwatchCache::evict()
+{
+    // Keep at least the most recently used entry.
+    while (m_size > m_maxSize && m_entries.size() > 1)
+    {
+        const Entry& entry = m_entries.back();
+        m_size -= entry.m_pixels.size();
+        m_index.erase(entry.m_key);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,112 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_SWATCHCACHE_H
+#define APPLESEED_MAYA_SWATCHCACHE_H
+
+// appleseed-maya headers.
+#include "appleseedmaya/murmurhash.h"
+
+// Build options header.
+#include "foundation/core/buildoptions.h"
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Standard headers.
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+// Forward declarations.
+namespace renderer  { class ShaderGroup; }
+class MImage;
+
+//
+// Cache of rendered swatch images, indexed by a hash of their content.
+//
+// The key of a swatch is the hash of its exported shader group, without the
+// names of the Maya nodes, so that identical networks share their swatches,
+// plus the resolution and the kind of swatch.
+//
+// Images are kept in memory in least recently used order, up to a size set
+// in megabytes with the APPLESEED_MAYA_SWATCH_CACHE_SIZE environment variable
+// (64 by default, 0 disables the cache). If the APPLESEED_MAYA_SWATCH_CACHE_DIR
+// environment variable is set, images are also stored in that directory and
+// found there by later Maya sessions.
+//
+
+class SwatchCache
+  : public foundation::NonCopyable
+{
+  public:
+    SwatchCache();
+
+    // Hash the content of a shader group: shader types, parameter values and connections.
+    static void hashShaderGroup(const renderer::ShaderGroup& shaderGroup, MurmurHash& hash);
+
+    // Copy a cached image to image, which must be allocated with the size of the swatch.
+    // Return false if the swatch is not in the cache.
+    bool find(const MurmurHash& key, MImage& image);
+
+    // Add a rendered image to the cache.
+    void insert(const MurmurHash& key, const MImage& image);
+
+    // Remove all the images kept in memory.
+    void clear();
+
+  private:
+    struct Entry
+    {
+        MurmurHash                  m_key;
+        unsigned int                m_width;
+        unsigned int                m_height;
+        std::vector<std::uint8_t>   m_pixels;   // BGRA
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    bool readFile(const MurmurHash& key, Entry& entry) const;
+    void writeFile(const Entry& entry) const;
+    std::string filePath(const MurmurHash& key) const;
+
+    void insertEntry(Entry& entry);
+    void evict();
+
+    const size_t                                m_maxSize;
+    const std::string                           m_directory;
+    EntryList                                   m_entries;      // most recently used first
+    std::map<MurmurHash, EntryList::iterator>   m_index;
+    size_t                                      m_size;
+    size_t                                      m_hits;
+    size_t                                      m_misses;
+};
+
+#endif  // !APPLESEED_MAYA_SWATCHCACHE_H
@@ -32,6 +32,10 @@
 // appleseed-maya headers.
 #include "appleseedmaya/appleseedsession.h"
 #include "appleseedmaya/logger.h"
+#include "appleseedmaya/murmurhash.h"
+#include "appleseedmaya/pixelkernels.h"
+#include "appleseedmaya/renderercontroller.h"
+#include "appleseedmaya/swatchcache.h"
 #include "appleseedmaya/utils.h"
 
 // Build options header.
@@ -49,6 +53,7 @@
 #include "renderer/api/project.h"
 #include "renderer/api/rendering.h"
 #include "renderer/api/scene.h"
+#include "renderer/api/shadergroup.h"
 
 // appleseed.foundation headers.
 #include "foundation/core/concepts/noncopyable.h"
@@ -69,19 +74,93 @@
 #include "appleseedmaya/_endmayaheaders.h"
 
 // Standard headers.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace asf = foundation;
 namespace asr = renderer;
 
 namespace
 {
+    // Version of the swatch scenes, part of the swatch cache keys.
+    // Increment it when the scenes change to ignore the cached swatches.
+    const int SwatchSceneVersion = 2;
+
+    // Number of rendering threads of each swatch render.
+    const size_t ThreadsPerSwatch = 2;
+
+    // Maximum number of swatches rendered in parallel. The number of threads used
+    // for swatches can be set with the APPLESEED_MAYA_SWATCH_THREADS environment
+    // variable and defaults to half the cores.
+    size_t maxConcurrentSwatches()
+    {
+        size_t threads = std::thread::hardware_concurrency() / 2;
+
+        if (const char* value = getenv("APPLESEED_MAYA_SWATCH_THREADS"))
+            threads = static_cast<size_t>(std::max(atoi(value), 0));
+
+        return std::max(threads / ThreadsPerSwatch, size_t(1));
+    }
+
+    // Swatches are rendered in passes of increasing quality, starting at
+    // DefaultSwatchSamples samples per pixel and multiplying it by SwatchPassSamplesFactor
+    // until the images of two passes match or the maximum quality is reached.
+    // The maximum number of samples per pixel can be set with the
+    // APPLESEED_MAYA_SWATCH_SAMPLES environment variable. Maya only displays
+    // the last pass, so by default a single pass is rendered.
+    const size_t DefaultSwatchSamples = 4;
+    const size_t SwatchPassSamplesFactor = 4;
+
+    // Maximum difference between two passes, in 8 bit levels, for an image to be converged.
+    const int SwatchConvergedThreshold = 2;
+
+    size_t maxSwatchSamples()
+    {
+        size_t samples = DefaultSwatchSamples;
+
+        if (const char* value = getenv("APPLESEED_MAYA_SWATCH_SAMPLES"))
+            samples = static_cast<size_t>(std::max(atoi(value), 1));
+
+        return samples;
+    }
+
+    bool swatchConverged(
+        const std::vector<std::uint8_t>&    previous,
+        const std::vector<std::uint8_t>&    current)
+    {
+        if (previous.size() != current.size())
+            return false;
+
+        for (size_t i = 0, e = current.size(); i < e; ++i)
+        {
+            if (std::abs(static_cast<int>(current[i]) - static_cast<int>(previous[i])) > SwatchConvergedThreshold)
+                return false;
+        }
+
+        return true;
+    }
+
+    enum SwatchScene
+    {
+        MaterialSwatchScene,
+        TextureSwatchScene
+    };
+
     class SwatchProject
       : public asf::NonCopyable
     {
       public:
         SwatchProject()
+          : m_sceneName("")
+          , m_busy(false)
         {
         }
 
@@ -93,8 +172,6 @@ namespace
             m_project = asr::ProjectFactory::create("project");
             m_project->add_default_configurations();
 
-            const size_t NumThreads = 2;
-
             // Insert some config params needed by the final renderer.
             asr::Configuration* cfg = m_project->configurations().get_by_name("final");
             asr::ParamArray* cfg_params = &cfg->get_parameters();
@@ -106,8 +183,9 @@ namespace
             cfg_params->insert("lighting_engine", "pt");
             cfg_params->insert("pixel_renderer", "uniform");
             cfg_params->insert("sampling_mode", "qmc");
-            cfg_params->insert("rendering_threads", NumThreads);
-            cfg_params->insert_path("uniform_pixel_renderer.samples", "4");
+            cfg_params->insert("rendering_threads", ThreadsPerSwatch);
+            cfg_params->insert_path("uniform_pixel_renderer.samples", "1");
+            cfg_params->insert_path("uniform_pixel_renderer.force_antialiasing", true);
 
             // Create some basic project entities.
 
@@ -195,6 +273,9 @@ namespace
 
         void createMaterialSceneGeometry()
         {
+            m_scene = MaterialSwatchScene;
+            m_sceneName = "material";
+
             // Create the light.
             asf::auto_release_ptr<asr::Light> light = asr::DirectionalLightFactory().create(
                 "light",
@@ -226,6 +307,9 @@ namespace
 
         void createTextureSceneGeometry()
         {
+            m_scene = TextureSwatchScene;
+            m_sceneName = "texture";
+
             // Create the geometry.
             const float size = 2.5f;
             asr::ParamArray params;
@@ -257,34 +341,78 @@ namespace
             m_mainAssembly->object_instances().insert(objInstance);
         }
 
-        void render(const size_t resolution, MImage& dstImage)
+        SwatchScene scene() const
         {
-            // Disable logging while rendering the swatch.
-            ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
+            return m_scene;
+        }
+
+        bool isBusy() const
+        {
+            return m_busy;
+        }
+
+        void setBusy(const bool busy)
+        {
+            m_busy = busy;
+        }
+
+        // Compute the cache key of the exported swatch.
+        // Return false if there is no exported shader group.
+        bool cacheKey(const size_t resolution, MurmurHash& key) const
+        {
+            const asr::ShaderGroup* shaderGroup = m_mainAssembly->shader_groups().get_by_index(0);
+            if (shaderGroup == nullptr)
+                return false;
+
+            // Swatches of identical shading networks are only rendered once.
+            SwatchCache::hashShaderGroup(*shaderGroup, key);
+            key.append(resolution);
+            key.append(maxSwatchSamples());
+            key.append(m_sceneName);
+            key.append(SwatchSceneVersion);
+            return true;
+        }
 
-            // Recreate the frame.
+        // Recreate the frame before rendering. Main thread only.
+        void prepareRender(const size_t resolution)
+        {
             asr::ParamArray frameParams = m_project->get_frame()->get_parameters();
             frameParams.insert("resolution", asf::Vector2u(resolution, resolution));
             asf::auto_release_ptr<asr::Frame> frame(asr::FrameFactory::create("beauty", frameParams));
             m_project->set_frame(frame);
 
-            // Render.
+            m_rendererController.set_status(asr::IRendererController::ContinueRendering);
+        }
+
+        // Render a pass of the swatch and copy its pixels. Called from a swatch render thread.
+        // Return false if the render was aborted.
+        bool renderPass(const size_t samples, std::vector<std::uint8_t>& pixels)
+        {
+            // The master renderer reads its parameters at the start of each render.
+            m_renderer->get_parameters().insert_path("uniform_pixel_renderer.samples", samples);
             m_renderer->render(m_rendererController);
-            copySwatchImage(dstImage);
+
+            if (m_rendererController.get_status() == asr::IRendererController::AbortRendering)
+                return false;
+
+            copySwatchImage(pixels);
+            return true;
         }
 
-      private:
-        static uint8_t to_uint8(const float c)
+        void abortRender()
         {
-            return static_cast<uint8_t>(asf::saturate(c) * 255.0f);
+            m_rendererController.set_status(asr::IRendererController::AbortRendering);
         }
 
-        void copySwatchImage(MImage& dstImage) const
+      private:
+        void copySwatchImage(std::vector<std::uint8_t>& pixels) const
         {
             const asf::Image& srcImage = m_project->get_frame()->image();
             const asf::CanvasProperties& props = srcImage.properties();
             size_t width = props.m_canvas_width;
 
+            pixels.resize(width * props.m_canvas_height * 4);
+
             for (size_t ty = 0; ty < props.m_tile_count_y; ++ty)
             {
                 for (size_t tx = 0; tx < props.m_tile_count_x; ++tx)
@@ -300,51 +428,196 @@ namespace
                     for (size_t j = 0, je = tile.get_height(); j < je; ++j)
                     {
                         // For swatches, we assume 4 8 bit channels.
+                        // Maya docs say RGBA, but it is actually BGRA.
                         const size_t y = y0 + j;
-                        uint8_t* dst = dstImage.pixels() + (y * width * 4) + (x0 * 4);
-
-                        for (size_t i = 0, ie = tile.get_width(); i < ie; ++i)
-                        {
-                            // Maya docs say RGBA, but it is actually BGRA.
-                            *dst++ = to_uint8(src[2]);
-                            *dst++ = to_uint8(src[1]);
-                            *dst++ = to_uint8(src[0]);
-                            *dst++ = 255;
-                            src += 4;
-                        }
+                        uint8_t* dst = pixels.data() + (y * width * 4) + (x0 * 4);
+                        PixelKernels::convertRGBAFloatToBGRA8(src, dst, tile.get_width());
+                        src += tile.get_width() * 4;
                     }
                 }
             }
         }
 
         asf::auto_release_ptr<asr::Project>  m_project;
+        SwatchScene                          m_scene;
+        const char*                          m_sceneName;
         asr::Assembly*                       m_mainAssembly;
         asr::Material*                       m_material;
         std::unique_ptr<asr::MasterRenderer> m_renderer;
-        asr::DefaultRendererController       m_rendererController;
+        RendererController                   m_rendererController;
+        bool                                 m_busy;
     };
 
-    SwatchProject       g_materialSwatchProject;
-    SwatchProject       g_textureSwatchProject;
-    asf::SearchPaths    g_resourceSearchPaths;
-}
+    //
+    // Swatch projects, created as needed up to the number of swatches rendered in parallel.
+    //
 
-const MString SwatchRenderer::name("AppleseedRenderSwatch");
-const MString SwatchRenderer::fullName("swatch/AppleseedRenderSwatch");
+    class SwatchProjectPool
+      : public asf::NonCopyable
+    {
+      public:
+        explicit SwatchProjectPool(const asf::SearchPaths& resourceSearchPaths)
+          : m_resourceSearchPaths(resourceSearchPaths)
+          , m_maxBusyProjects(maxConcurrentSwatches())
+          , m_busyProjects(0)
+        {
+        }
 
-void SwatchRenderer::initialize(const MString& /*pluginPath*/)
+        ~SwatchProjectPool()
+        {
+            assert(m_busyProjects == 0);
+
+            // Disable logging from appleseed.
+            ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
+
+            for (size_t i = 0, e = m_projects.size(); i < e; ++i)
+                m_projects[i]->uninitialize();
+        }
+
+        // Return a project ready to export a swatch of a scene.
+        // Return nullptr if the maximum number of swatches are rendering.
+        SwatchProject* acquire(const SwatchScene scene)
+        {
+            if (m_busyProjects >= m_maxBusyProjects)
+                return nullptr;
+
+            SwatchProject* project = nullptr;
+
+            for (size_t i = 0, e = m_projects.size(); i < e; ++i)
+            {
+                if (m_projects[i]->scene() == scene && !m_projects[i]->isBusy())
+                {
+                    project = m_projects[i].get();
+                    break;
+                }
+            }
+
+            if (project == nullptr)
+                project = createProject(scene);
+
+            // Disable logging from appleseed while swatches render.
+            if (m_busyProjects++ == 0)
+                m_logLevel.reset(new ScopedSetLoggerVerbosity(asf::LogMessage::Error));
+
+            project->setBusy(true);
+            return project;
+        }
+
+        void release(SwatchProject* project)
+        {
+            assert(project->isBusy());
+            project->setBusy(false);
+
+            if (--m_busyProjects == 0)
+                m_logLevel.reset();
+        }
+
+      private:
+        SwatchProject* createProject(const SwatchScene scene)
+        {
+            const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+            std::unique_ptr<SwatchProject> project(new SwatchProject());
+
+            {
+                // Disable logging from appleseed.
+                ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
+
+                project->initialize(m_resourceSearchPaths);
+
+                if (scene == MaterialSwatchScene)
+                    project->createMaterialSceneGeometry();
+                else
+                    project->createTextureSceneGeometry();
+            }
+
+            RENDERER_LOG_DEBUG(
+                "Created swatch project %s in %f s.",
+                asf::pretty_uint(m_projects.size() + 1).c_str(),
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+
+            m_projects.push_back(std::move(project));
+            return m_projects.back().get();
+        }
+
+        const asf::SearchPaths&                         m_resourceSearchPaths;
+        const size_t                                    m_maxBusyProjects;
+        size_t                                          m_busyProjects;
+        std::vector<std::unique_ptr<SwatchProject>>     m_projects;
+        std::unique_ptr<ScopedSetLoggerVerbosity>       m_logLevel;
+    };
+
+    asf::SearchPaths                    g_resourceSearchPaths;
+    std::unique_ptr<SwatchProjectPool>  g_swatchProjectPool;
+    std::unique_ptr<SwatchCache>        g_swatchCache;
+}
+
+struct SwatchRenderer::RenderJob
 {
+    // Render the passes of the swatch. Called from the job thread.
+    void render()
     {
-        // Disable logging from appleseed.
-        ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
+        const size_t maxSamples = maxSwatchSamples();
+        std::vector<std::uint8_t> pixels;
+        std::vector<std::uint8_t> previousPixels;
+
+        const size_t firstSamples = std::min(DefaultSwatchSamples, maxSamples);
+
+        for (size_t samples = firstSamples; ; samples = std::min(samples * SwatchPassSamplesFactor, maxSamples))
+        {
+            if (!m_project->renderPass(samples, pixels))
+                break;
 
-        g_materialSwatchProject.initialize(g_resourceSearchPaths);
-        g_materialSwatchProject.createMaterialSceneGeometry();
+            // Cheap materials, like constant colors, converge after the second pass.
+            const bool converged = swatchConverged(previousPixels, pixels);
 
-        g_textureSwatchProject.initialize(g_resourceSearchPaths);
-        g_textureSwatchProject.createTextureSceneGeometry();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pixels = pixels;
+                ++m_passes;
+            }
+
+            if (converged || samples >= maxSamples)
+                break;
+
+            previousPixels.swap(pixels);
+        }
+
+        m_done = true;
     }
 
+    // Copy the pixels of the last pass if it wasn't copied yet. Main thread only.
+    void copyLastPass(MImage& image)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_copiedPasses == m_passes)
+            return;
+
+        std::memcpy(image.pixels(), m_pixels.data(), m_pixels.size());
+        m_copiedPasses = m_passes;
+    }
+
+    SwatchProject*              m_project;
+    MurmurHash                  m_key;
+    bool                        m_cacheable;
+    std::mutex                  m_mutex;
+    std::vector<std::uint8_t>   m_pixels;
+    size_t                      m_passes;
+    size_t                      m_copiedPasses;
+    std::atomic<bool>           m_done;
+    std::thread                 m_thread;
+};
+
+const MString SwatchRenderer::name("AppleseedRenderSwatch");
+const MString SwatchRenderer::fullName("swatch/AppleseedRenderSwatch");
+
+void SwatchRenderer::initialize(const MString& /*pluginPath*/)
+{
+    // The swatch projects are created by the first swatch requests,
+    // to keep them out of the plugin loading time.
+    g_swatchProjectPool.reset(new SwatchProjectPool(g_resourceSearchPaths));
+    g_swatchCache.reset(new SwatchCache());
+
     RENDERER_LOG_INFO("Initialized swatch renderer.");
 }
 
@@ -354,8 +627,9 @@ void SwatchRenderer::uninitialize()
         // Disable logging from appleseed.
         ScopedSetLoggerVerbosity logLevel(asf::LogMessage::Error);
 
-        g_materialSwatchProject.uninitialize();
-        g_textureSwatchProject.uninitialize();
+        g_swatchProjectPool.reset();
+        g_swatchCache->clear();
+        g_swatchCache.reset();
     }
 
     RENDERER_LOG_INFO("Uninitialized swatch renderer.");
@@ -377,8 +651,32 @@ SwatchRenderer::SwatchRenderer(
 {
 }
 
+SwatchRenderer::~SwatchRenderer()
+{
+    // Maya deletes the swatch renderers of nodes that are no longer displayed.
+    if (m_job)
+    {
+        m_job->m_project->abortRender();
+        m_job->m_thread.join();
+        g_swatchProjectPool->release(m_job->m_project);
+    }
+}
+
 bool SwatchRenderer::doIteration()
 {
+    // Wait for the render started by a previous iteration.
+    if (m_job)
+    {
+        // Keep the swatch image up to date with the passes rendered so far.
+        m_job->copyLastPass(image());
+
+        if (!m_job->m_done)
+            return false;
+
+        finishRender();
+        return true;
+    }
+
     MFnDependencyNode depNodeFn(node());
     const MString name = depNodeFn.name();
     const MString typeName = depNodeFn.typeName();
@@ -393,25 +691,68 @@ bool SwatchRenderer::doIteration()
         resolution());
     */
 
-    // Allocate the pixels.
-    image().create(resolution(), resolution());
-
+    SwatchScene scene;
     if (strstr(classification.asChar(), "rendernode/appleseed/surface") != nullptr)
+        scene = MaterialSwatchScene;
+    else if (strstr(classification.asChar(), "rendernode/appleseed/texture") != nullptr)
+        scene = TextureSwatchScene;
+    else
+        return false;
+
+    // Try again on the next iteration if all the projects are busy.
+    SwatchProject* project = g_swatchProjectPool->acquire(scene);
+    if (project == nullptr)
+        return false;
+
+    if (scene == MaterialSwatchScene)
     {
-        if (AppleseedSession::exportMaterialSwatch(g_materialSwatchProject.getProject(), node()))
+        if (!AppleseedSession::exportMaterialSwatch(project->getProject(), node()))
         {
-            g_materialSwatchProject.render(resolution(), image());
-            return true;
+            g_swatchProjectPool->release(project);
+            return false;
         }
     }
-    else if (strstr(classification.asChar(), "rendernode/appleseed/texture") != nullptr)
+    else
+        AppleseedSession::exportTextureSwatch(project->getProject(), node());
+
+    // Allocate the pixels.
+    image().create(resolution(), resolution());
+
+    MurmurHash key;
+    const bool cacheable = project->cacheKey(resolution(), key);
+
+    if (cacheable && g_swatchCache->find(key, image()))
     {
-        AppleseedSession::exportTextureSwatch(g_textureSwatchProject.getProject(), node());
-        {
-            g_textureSwatchProject.render(resolution(), image());
-            return true;
-        }
+        g_swatchProjectPool->release(project);
+        return true;
     }
 
+    // Render in the background, the next iterations wait for the result.
+    project->prepareRender(resolution());
+
+    m_job.reset(new RenderJob());
+    m_job->m_project = project;
+    m_job->m_key = key;
+    m_job->m_cacheable = cacheable;
+    m_job->m_passes = 0;
+    m_job->m_copiedPasses = 0;
+    m_job->m_done = false;
+
+    RenderJob* job = m_job.get();
+    m_job->m_thread = std::thread([job]() { job->render(); });
+
     return false;
 }
+
+void SwatchRenderer::finishRender()
+{
+    m_job->m_thread.join();
+    m_job->copyLastPass(image());
+
+    // Only the final pass is cached.
+    if (m_job->m_cacheable && m_job->m_passes != 0)
+        g_swatchCache->insert(m_job->m_key, image());
+
+    g_swatchProjectPool->release(m_job->m_project);
+    m_job.reset();
+}
@@ -34,6 +34,9 @@
 #include <maya/MSwatchRenderBase.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
+// Standard headers.
+#include <memory>
+
 class SwatchRenderer
   : public MSwatchRenderBase
 {
@@ -49,13 +52,23 @@ class SwatchRenderer
         MObject renderNode,
         int     imageResolution);
 
+    ~SwatchRenderer() override;
+
+    // Start rendering the swatch in the background and return false
+    // until it is ready. Swatches found in the cache are returned at once.
     bool doIteration() override;
 
   private:
+    struct RenderJob;
+
     SwatchRenderer(
         MObject dependNode,
         MObject renderNode,
         int     imageResolution);
+
+    void finishRender();
+
+    std::unique_ptr<RenderJob> m_job;
 };
 
 #endif  // !APPLESEED_MAYA_SWATCHRENDERER_H
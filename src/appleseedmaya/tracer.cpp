@@ -0,0 +1,240 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Interface header.
+#include "tracer.h"
+
+// appleseed-maya headers.
+#include "appleseedmaya/logger.h"
+#include "appleseedmaya/utils.h"
+
+// Standard headers.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct Event
+    {
+        char            m_phase;
+        const char*     m_category;
+        std::int64_t    m_timestamp;
+        std::string     m_name;
+        std::string     m_args;
+    };
+
+    // Events recorded by a thread.
+    // The mutex is only contended while flushing.
+    struct ThreadEvents
+    {
+        std::mutex          m_mutex;
+        unsigned int        m_threadId;
+        std::vector<Event>  m_events;
+    };
+
+    std::string g_traceFile;
+    Clock::time_point g_start;
+
+    std::mutex g_threadsMutex;
+    std::vector<std::shared_ptr<ThreadEvents>> g_threads;
+    unsigned int g_nextThreadId = 0;
+
+    std::mutex g_fileMutex;
+
+    ThreadEvents& threadEvents()
+    {
+        thread_local std::shared_ptr<ThreadEvents> events;
+
+        if (!events)
+        {
+            events = std::make_shared<ThreadEvents>();
+
+            std::lock_guard<std::mutex> lock(g_threadsMutex);
+            events->m_threadId = g_nextThreadId++;
+            g_threads.push_back(events);
+        }
+
+        return *events;
+    }
+
+    void addEvent(
+        const char          phase,
+        const char*         category,
+        const std::string&  name,
+        const std::string&  args)
+    {
+        Event event;
+        event.m_phase = phase;
+        event.m_category = category;
+        event.m_timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - g_start).count();
+        event.m_name = name;
+        event.m_args = args;
+
+        ThreadEvents& events = threadEvents();
+        std::lock_guard<std::mutex> lock(events.m_mutex);
+        events.m_events.push_back(std::move(event));
+    }
+
+    void writeEvent(std::ostream& os, const unsigned int threadId, const Event& event)
+    {
+        os << "{\"ph\":\"" << event.m_phase << "\",\"pid\":1,\"tid\":" << threadId;
+        os << ",\"ts\":" << event.m_timestamp;
+
+        if (event.m_category)
+            os << ",\"cat\":\"" << event.m_category << '"';
+
+        if (!event.m_name.empty())
+        {
+            os << ",\"name\":";
+            writeJSONString(os, event.m_name);
+        }
+
+        if (!event.m_args.empty())
+            os << ",\"args\":{" << event.m_args << '}';
+
+        os << "},\n";
+    }
+}
+
+namespace Tracer
+{
+
+namespace Detail
+{
+    std::atomic<bool> g_enabled(false);
+}
+
+MStatus initialize()
+{
+    const char* traceFile = getenv("APPLESEED_MAYA_TRACE_FILE");
+    if (traceFile == nullptr || *traceFile == '\0')
+        return MS::kSuccess;
+
+    // Events are appended to the file as they are flushed. The closing
+    // bracket of the JSON array is optional in the trace event format.
+    std::ofstream file(traceFile, std::ios::out | std::ios::trunc);
+    if (!file)
+    {
+        RENDERER_LOG_WARNING("Could not open trace file %s", traceFile);
+        return MS::kSuccess;
+    }
+
+    file << "[\n";
+
+    g_traceFile = traceFile;
+    g_start = Clock::now();
+    Detail::g_enabled = true;
+
+    setThreadName("Main thread");
+
+    RENDERER_LOG_INFO("Writing trace events to %s", traceFile);
+    return MS::kSuccess;
+}
+
+MStatus uninitialize()
+{
+    if (enabled())
+    {
+        flush();
+        Detail::g_enabled = false;
+    }
+
+    return MS::kSuccess;
+}
+
+void setThreadName(const char* name)
+{
+    if (enabled())
+    {
+        std::stringstream args;
+        args << "\"name\":";
+        writeJSONString(args, name);
+        addEvent('M', nullptr, "thread_name", args.str());
+    }
+}
+
+void beginEvent(const char* category, const std::string& name, const std::string& args)
+{
+    addEvent('B', category, name, args);
+}
+
+void endEvent(const char* category)
+{
+    addEvent('E', category, std::string(), std::string());
+}
+
+void flush()
+{
+    if (!enabled())
+        return;
+
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+
+    {
+        std::lock_guard<std::mutex> lock(g_threadsMutex);
+        threads = g_threads;
+
+        // Forget the threads that have exited, only our copy and g_threads
+        // reference their events. Their last events are written below.
+        g_threads.erase(
+            std::remove_if(
+                g_threads.begin(),
+                g_threads.end(),
+                [](const std::shared_ptr<ThreadEvents>& t) { return t.use_count() == 2; }),
+            g_threads.end());
+    }
+
+    std::lock_guard<std::mutex> lock(g_fileMutex);
+    std::ofstream file(g_traceFile.c_str(), std::ios::out | std::ios::app);
+
+    for (size_t i = 0, e = threads.size(); i < e; ++i)
+    {
+        std::vector<Event> events;
+
+        {
+            std::lock_guard<std::mutex> lock(threads[i]->m_mutex);
+            events.swap(threads[i]->m_events);
+        }
+
+        for (size_t j = 0, je = events.size(); j < je; ++j)
+            writeEvent(file, threads[i]->m_threadId, events[j]);
+    }
+
+    if (!file)
+        RENDERER_LOG_WARNING("Could not write trace file %s", g_traceFile.c_str());
+}
+
+} // Tracer
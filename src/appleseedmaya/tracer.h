@@ -0,0 +1,115 @@
+
+//
+// This source file is part of appleseed.
+// Visit https://appleseedhq.net/ for additional information and resources.
+//
+// This software is released under the MIT license.
+//
+// Copyright (c) 2019 Esteban Tovagliari, The appleseedhq Organization
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef APPLESEED_MAYA_TRACER_H
+#define APPLESEED_MAYA_TRACER_H
+
+// appleseed.foundation headers.
+#include "foundation/core/concepts/noncopyable.h"
+
+// Maya headers.
+#include "appleseedmaya/_beginmayaheaders.h"
+#include <maya/MStatus.h>
+#include "appleseedmaya/_endmayaheaders.h"
+
+// Standard headers.
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+//
+// Records spans of work in the Chrome trace event format.
+// The resulting file can be loaded in chrome://tracing or Perfetto.
+//
+// Tracing is enabled by setting the APPLESEED_MAYA_TRACE_FILE environment
+// variable to the path of the trace file. When disabled, recording an event
+// only costs the check of an atomic flag.
+//
+
+namespace Tracer
+{
+
+namespace Detail
+{
+    extern std::atomic<bool> g_enabled;
+}
+
+MStatus initialize();
+MStatus uninitialize();
+
+// Return true if trace events are being recorded.
+inline bool enabled()
+{
+    return Detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+// Name the calling thread in the trace.
+void setThreadName(const char* name);
+
+// Begin and end a span in the calling thread. Spans must be properly nested.
+// The args string, if not empty, must be the body of a JSON object.
+void beginEvent(const char* category, const std::string& name, const std::string& args = std::string());
+void endEvent(const char* category);
+
+// Write all the events recorded so far to the trace file.
+void flush();
+
+//
+// Record a span covering the lifetime of the object.
+//
+
+class ScopedEvent
+  : public foundation::NonCopyable
+{
+  public:
+    ScopedEvent(const char* category, const char* name)
+      : m_category(enabled() ? category : nullptr)
+    {
+        if (m_category)
+            beginEvent(m_category, name);
+    }
+
+    ScopedEvent(const char* category, const std::string& name)
+      : m_category(enabled() ? category : nullptr)
+    {
+        if (m_category)
+            beginEvent(m_category, name);
+    }
+
+    ~ScopedEvent()
+    {
+        if (m_category)
+            endEvent(m_category);
+    }
+
+  private:
+    const char* m_category;
+};
+
+} // Tracer
+
+#endif  // !APPLESEED_MAYA_TRACER_H
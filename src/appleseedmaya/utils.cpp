@@ -40,6 +40,10 @@
 #include <maya/MSelectionList.h>
 #include "appleseedmaya/_endmayaheaders.h"
 
+// Standard headers.
+#include <cstdio>
+#include <ostream>
+
 MStatus getDependencyNodeByName(const MString& name, MObject& node)
 {
     MSelectionList selList;
@@ -87,3 +91,26 @@ void Computation::thowIfInterruptRequested()
     if (m_computation.isInterruptRequested())
         throw AbortRequested();
 }
+
+void writeJSONString(std::ostream& os, const std::string& str)
+{
+    os << '"';
+
+    for (size_t i = 0, e = str.size(); i < e; ++i)
+    {
+        const char c = str[i];
+
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            os << buffer;
+        }
+        else
+            os << c;
+    }
+
+    os << '"';
+}
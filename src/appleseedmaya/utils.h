@@ -48,6 +48,7 @@
 
 // Standard headers.
 #include <cstring>
+#include <iosfwd>
 #include <memory>
 #include <string>
 
@@ -66,6 +67,37 @@ struct MStringCompareLess
     }
 };
 
+//
+// MStringHash, MStringEqual
+//
+//  Function object classes for MString hashing and equality comparison.
+//  Used in unordered maps, to avoid MString <-> std::string conversions.
+//
+
+struct MStringHash
+{
+    size_t operator()(const MString& s) const
+    {
+        // FNV-1a.
+        size_t hash = 2166136261u;
+        for (const char* p = s.asChar(); *p != '\0'; ++p)
+        {
+            hash ^= static_cast<unsigned char>(*p);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+};
+
+struct MStringEqual
+{
+    bool operator()(const MString& a, const MString& b) const
+    {
+        return strcmp(a.asChar(), b.asChar()) == 0;
+    }
+};
+
 //
 // AppleseedEntityPtr.
 //
@@ -242,6 +274,9 @@ inline void flip_pixel_interval(const T size, T& xmin, T& xmax)
     xmin = flip_pixel_coordinate(size, tmp);
 }
 
+// Write a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+void writeJSONString(std::ostream& os, const std::string& str);
+
 //
 // Deleter that calls delete[] for use with C++11 shared_ptr.
 // TODO: check that we really need this.